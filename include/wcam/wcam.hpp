@@ -1,14 +1,36 @@
 #pragma once
+#include <string>
 #include <vector>
+#include "../../src/AdaptiveQualitySettings.hpp"
+#include "../../src/Backend.hpp"
+#include "../../src/BayerSettings.hpp"
+#include "../../src/Burst.hpp"
 #include "../../src/DeviceId.hpp"
+#include "../../src/DuplicateFramesPolicy.hpp"
 #include "../../src/FirstRowIs.hpp"
+#include "../../src/FrameMetadata.hpp"
+#include "../../src/FrameSlice.hpp"
+#include "../../src/HardwareTimestampsSettings.hpp"
+#include "../../src/History.hpp"
 #include "../../src/Image.hpp"
 #include "../../src/Info.hpp"
+#include "../../src/LatencySettings.hpp"
 #include "../../src/KeepLibraryAlive.hpp"
 #include "../../src/MaybeImage.hpp"
+#include "../../src/MemoryBudget.hpp"
+#include "../../src/Mosaic.hpp"
+#include "../../src/MotionGateSettings.hpp"
+#include "../../src/PacingSettings.hpp"
+#include "../../src/PipelineStage.hpp"
+#include "../../src/PooledBuffer.hpp"
 #include "../../src/Resolution.hpp"
 #include "../../src/ResolutionsMap.hpp"
 #include "../../src/SharedWebcam.hpp"
+#include "../../src/Snapshot.hpp"
+#include "../../src/Still.hpp"
+#include "../../src/SyncGroup.hpp"
+#include "../../src/ThreadSettings.hpp"
+#include "../../src/VirtualWebcam.hpp"
 #include "../../src/internal/ImageFactory.hpp"
 #include "../../src/overloaded.hpp"
 
@@ -20,6 +42,20 @@ auto all_webcams_info() -> std::vector<Info>;
 /// Starts capturing the requested camera. If it safe to call it an a camera that is already captured, we will just reuse the existing capture.
 auto open_webcam(DeviceId const&) -> SharedWebcam;
 
+/// Creates a camera that shows the `region` of the images of `physical_webcam`. It appears in all_webcams_info() while the physical camera is plugged in, and you can open it like any other camera.
+/// The physical camera is captured and decoded only once, no matter how many virtual cameras use it, and each virtual camera only converts its own region.
+/// The position and size of the region are rounded down to even numbers, because some pixel formats share their colors between pairs of pixels.
+/// Calling it several times with the same arguments gives you the same camera.
+auto add_virtual_webcam(DeviceId const& physical_webcam, CropRegion region, std::string name) -> DeviceId;
+/// The virtual camera then behaves as if it was unplugged
+void remove_virtual_webcam(DeviceId const&);
+
+/// Adds the cameras of `backend` to all_webcams_info(), and allows you to open them like any other camera. See Backend for more details.
+/// Registering another backend with the same `name` replaces it. The name is part of the DeviceId of its cameras, so keep it the same across runs of your application. It must not contain ':'.
+void register_backend(std::string name, std::shared_ptr<Backend>);
+/// Its cameras then behave as if they were unplugged. The captures that are already running keep the backend alive until they stop.
+void unregister_backend(std::string const& name);
+
 auto get_selected_resolution(DeviceId const&) -> Resolution;
 void set_selected_resolution(DeviceId const&, Resolution);
 
@@ -32,4 +68,50 @@ void set_image_type()
 
 auto get_resolutions_map() -> ResolutionsMap&;
 
+/// Allows us to make the capture cheaper when the machine can't keep up. See AdaptiveQualitySettings for more details.
+auto get_adaptive_quality(DeviceId const&) -> AdaptiveQualitySettings;
+void set_adaptive_quality(DeviceId const&, AdaptiveQualitySettings);
+
+auto get_duplicate_frames_policy(DeviceId const&) -> DuplicateFramesPolicy;
+void set_duplicate_frames_policy(DeviceId const&, DuplicateFramesPolicy);
+
+/// Only publishes the frames in which something moved. See MotionGateSettings for more details.
+auto get_motion_gate(DeviceId const&) -> MotionGateSettings;
+void set_motion_gate(DeviceId const&, MotionGateSettings);
+
+/// Reads the timestamps of the camera itself. See HardwareTimestampsSettings for more details.
+auto get_hardware_timestamps(DeviceId const&) -> HardwareTimestampsSettings;
+void set_hardware_timestamps(DeviceId const&, HardwareTimestampsSettings);
+
+/// How the images of Bayer cameras are reconstructed. See BayerSettings for more details.
+auto get_bayer(DeviceId const&) -> BayerSettings;
+void set_bayer(DeviceId const&, BayerSettings);
+
+/// Allows you to get the most recent frames, at the cost of dropping some. See LatencySettings for more details.
+auto get_latency(DeviceId const&) -> LatencySettings;
+void set_latency(DeviceId const&, LatencySettings);
+
+/// Limits the memory used by the frames of all the cameras. See MemoryBudget for more details.
+auto get_memory_budget() -> MemoryBudget;
+void set_memory_budget(MemoryBudget);
+/// Limits the memory used by the frames of one camera. Applies on top of the global budget.
+auto get_memory_budget(DeviceId const&) -> MemoryBudget;
+void set_memory_budget(DeviceId const&, MemoryBudget);
+auto memory_usage() -> MemoryUsage;
+auto memory_usage(DeviceId const&) -> MemoryUsage;
+
+/// Keeps the last few seconds of frames of a camera. See HistorySettings for more details.
+/// Disabling it clears the history.
+auto get_history(DeviceId const&) -> HistorySettings;
+void set_history(DeviceId const&, HistorySettings);
+/// The frames received during the last `duration`, from the oldest to the most recent. They are not decoded, so this is cheap.
+auto extract_history(DeviceId const&, std::chrono::milliseconds duration) -> std::vector<HistoryFrame>;
+/// Decodes the frames in parallel. The returned images are in the same order as the frames.
+auto decode_history(std::vector<HistoryFrame> const&) -> std::vector<MaybeImage>;
+
+/// Controls the name, priority and CPU affinity of the threads that wcam runs in the background (e.g. to pin the captures on isolated cores).
+/// Threads that are already running will apply the new settings before processing their next frame.
+auto get_thread_settings(ThreadRole) -> ThreadSettings;
+void set_thread_settings(ThreadRole, ThreadSettings);
+
 } // namespace wcam
\ No newline at end of file
@@ -0,0 +1,342 @@
+// Measures what each camera actually sustains in each of its modes, which is often less than what it advertises (many cameras fall to half rate at high resolutions, or in low light).
+// Usage: wcam-probe [--seconds N] [--json path]
+// Prints a table, and then the same results as JSON (on stdout, or in the given file).
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "wcam/wcam.hpp"
+
+using namespace std::chrono_literals;
+
+/// Counts the frames that reach the consumers. We only implement the RGB overload, so that the decode cost that we measure includes the conversion to RGB that a simple application would pay.
+class Image : public wcam::Image { // NOLINT(*special-member-functions)
+public:
+    void set_data(wcam::ImageDataView<wcam::RGB24> const& rgb_data) override
+    {
+        _resolution = rgb_data.resolution();
+        delivered_frames_count().fetch_add(1);
+    }
+
+    auto resolution() const -> wcam::Resolution { return _resolution; }
+
+    static auto delivered_frames_count() -> std::atomic<uint64_t>&
+    {
+        static auto instance = std::atomic<uint64_t>{0};
+        return instance;
+    }
+
+private:
+    wcam::Resolution _resolution{};
+};
+
+struct Options {
+    std::chrono::milliseconds  duration{3s};
+    std::optional<std::string> json_path{};
+};
+
+struct ModeResult {
+    std::string                camera{};
+    wcam::Resolution           resolution{};
+    std::optional<std::string> error{};
+    std::string                format{};
+    size_t                     frames_count{0};
+    double                     fps{0.};           // Frames sent by the camera, per second
+    double                     drop_rate{0.};     // Estimated from the gaps between the timestamps of the frames, because the nominal frame rate of the mode is not known
+    double                     delivered_fps{0.}; // Frames that reached the consumers, per second
+    double                     bytes_per_frame{0.};
+    double                     decode_ms{0.};     // Average cost to decode / convert one frame to RGB
+};
+
+static auto format_name(wcam::HistoryFrameFormat format) -> std::string
+{
+    switch (format)
+    {
+    case wcam::HistoryFrameFormat::MJPEG: return "MJPEG";
+    case wcam::HistoryFrameFormat::YUYV: return "YUYV";
+    case wcam::HistoryFrameFormat::BGR24: return "BGR24";
+    case wcam::HistoryFrameFormat::NV12: return "NV12";
+    case wcam::HistoryFrameFormat::I420: return "I420";
+    case wcam::HistoryFrameFormat::BayerRGGB8: return "BayerRGGB8";
+    case wcam::HistoryFrameFormat::BayerBGGR8: return "BayerBGGR8";
+    case wcam::HistoryFrameFormat::BayerGRBG8: return "BayerGRBG8";
+    case wcam::HistoryFrameFormat::BayerGBRG8: return "BayerGBRG8";
+    case wcam::HistoryFrameFormat::BayerRGGB10P: return "BayerRGGB10P";
+    case wcam::HistoryFrameFormat::BayerBGGR10P: return "BayerBGGR10P";
+    case wcam::HistoryFrameFormat::BayerGRBG10P: return "BayerGRBG10P";
+    case wcam::HistoryFrameFormat::BayerGBRG10P: return "BayerGBRG10P";
+    case wcam::HistoryFrameFormat::GRAY8: return "GRAY8";
+    case wcam::HistoryFrameFormat::GRAY16: return "GRAY16";
+    case wcam::HistoryFrameFormat::GRAY10: return "GRAY10";
+    case wcam::HistoryFrameFormat::GRAY10P: return "GRAY10P";
+    }
+    return "Unknown";
+}
+
+static auto seconds(std::chrono::steady_clock::duration duration) -> double
+{
+    return std::chrono::duration<double>{duration}.count();
+}
+
+/// Waits until the camera gives us its first image at `resolution`, because the previous mode might still be running for a little while
+static auto wait_for_first_image(wcam::SharedWebcam const& webcam, wcam::Resolution resolution) -> std::optional<std::string>
+{
+    auto const deadline = std::chrono::steady_clock::now() + 10s;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        auto const maybe_image = webcam.image();
+        if (auto const* error = std::get_if<wcam::CaptureError>(&maybe_image))
+            return wcam::to_string(*error);
+        if (auto const* image = std::get_if<std::shared_ptr<wcam::Image const>>(&maybe_image))
+        {
+            auto const* probe_image = dynamic_cast<Image const*>(image->get());
+            if (probe_image && probe_image->resolution() == resolution)
+                return std::nullopt;
+        }
+        std::this_thread::sleep_for(5ms);
+    }
+    return "The camera didn't give us any image";
+}
+
+/// The frames that are much further apart than usual are the ones after some frames that the camera (or the driver) dropped
+static auto estimated_dropped_frames_count(std::vector<wcam::HistoryFrame> const& frames) -> double
+{
+    auto intervals = std::vector<double>{};
+    for (size_t i = 1; i < frames.size(); ++i)
+        intervals.push_back(seconds(frames[i].timestamp - frames[i - 1].timestamp));
+    if (intervals.empty())
+        return 0.;
+
+    auto sorted_intervals = intervals;
+    std::nth_element(sorted_intervals.begin(), sorted_intervals.begin() + static_cast<std::ptrdiff_t>(sorted_intervals.size() / 2), sorted_intervals.end());
+    auto const median_interval = sorted_intervals[sorted_intervals.size() / 2];
+    if (median_interval <= 0.)
+        return 0.;
+
+    double dropped_frames_count = 0.;
+    for (auto const interval : intervals)
+        dropped_frames_count += std::max(0., std::round(interval / median_interval) - 1.);
+    return dropped_frames_count;
+}
+
+/// Decodes the frames one by one, so that we measure the cost of a single frame and not the parallelism of decode_history()
+static auto average_decode_ms(std::vector<wcam::HistoryFrame> const& frames) -> double
+{
+    size_t const frames_count = std::min<size_t>(frames.size(), 30);
+    if (frames_count == 0)
+        return 0.;
+
+    auto total = std::chrono::steady_clock::duration{0};
+    for (size_t i = 0; i < frames_count; ++i)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        std::ignore      = wcam::decode_history({frames[i]});
+        total += std::chrono::steady_clock::now() - start;
+    }
+    return seconds(total) * 1000. / static_cast<double>(frames_count);
+}
+
+static auto probe_mode(wcam::SharedWebcam const& webcam, wcam::Info const& info, wcam::Resolution resolution, Options const& options) -> ModeResult
+{
+    auto result = ModeResult{.camera = info.name, .resolution = resolution};
+
+    wcam::set_selected_resolution(info.id, resolution);
+    if (auto const error = wait_for_first_image(webcam, resolution))
+    {
+        result.error = *error;
+        return result;
+    }
+
+    auto const start                     = std::chrono::steady_clock::now();
+    auto const delivered_frames_at_start = Image::delivered_frames_count().load();
+    std::this_thread::sleep_for(options.duration);
+    auto const end                    = std::chrono::steady_clock::now();
+    auto const delivered_frames_count = Image::delivered_frames_count().load() - delivered_frames_at_start;
+
+    auto frames = wcam::extract_history(info.id, std::chrono::duration_cast<std::chrono::milliseconds>(end - start) + 1s);
+    std::erase_if(frames, [&](wcam::HistoryFrame const& frame) {
+        return frame.timestamp < start || frame.resolution != resolution;
+    });
+    if (frames.size() < 2)
+    {
+        result.error = "The camera gave us less than 2 frames";
+        return result;
+    }
+
+    auto   formats_count = std::map<std::string, size_t>{};
+    size_t total_bytes   = 0;
+    for (auto const& frame : frames)
+    {
+        formats_count[format_name(frame.format)]++;
+        total_bytes += frame.data_size;
+    }
+    auto const dropped_frames_count = estimated_dropped_frames_count(frames);
+
+    result.format          = std::max_element(formats_count.begin(), formats_count.end(), [](auto const& a, auto const& b) { return a.second < b.second; })->first;
+    result.frames_count    = frames.size();
+    result.fps             = static_cast<double>(frames.size() - 1) / seconds(frames.back().timestamp - frames.front().timestamp);
+    result.drop_rate       = dropped_frames_count / (static_cast<double>(frames.size()) + dropped_frames_count);
+    result.delivered_fps   = static_cast<double>(delivered_frames_count) / seconds(end - start);
+    result.bytes_per_frame = static_cast<double>(total_bytes) / static_cast<double>(frames.size());
+    result.decode_ms       = average_decode_ms(frames);
+    return result;
+}
+
+static auto probe_webcam(wcam::Info const& info, Options const& options) -> std::vector<ModeResult>
+{
+    auto const previous_history    = wcam::get_history(info.id);
+    auto const previous_resolution = wcam::get_selected_resolution(info.id);
+    wcam::set_history(info.id, {
+                                   .enabled   = true,
+                                   .duration  = options.duration + 2s,
+                                   .max_bytes = 512'000'000, // Enough for a few seconds of uncompressed 1080p frames. Above that, we measure over the most recent frames only.
+                               });
+
+    auto results = std::vector<ModeResult>{};
+    {
+        auto const webcam = wcam::open_webcam(info.id);
+        for (auto const& resolution : info.resolutions)
+        {
+            std::fprintf(stderr, "Probing %s at %ux%u...\n", info.name.c_str(), resolution.width(), resolution.height());
+            results.push_back(probe_mode(webcam, info, resolution, options));
+        }
+    }
+
+    wcam::set_history(info.id, previous_history);
+    wcam::set_selected_resolution(info.id, previous_resolution);
+    return results;
+}
+
+static void print_table(std::vector<ModeResult> const& results)
+{
+    std::printf("%-32s %-11s %-12s %8s %7s %10s %10s %10s\n", "Camera", "Resolution", "Format", "FPS", "Drops", "Delivered", "KB/frame", "Decode ms");
+    for (auto const& result : results)
+    {
+        auto const resolution = std::to_string(result.resolution.width()) + "x" + std::to_string(result.resolution.height());
+        if (result.error)
+        {
+            std::printf("%-32.32s %-11s %s\n", result.camera.c_str(), resolution.c_str(), result.error->c_str());
+            continue;
+        }
+        std::printf(
+            "%-32.32s %-11s %-12s %8.2f %6.1f%% %10.2f %10.1f %10.2f\n",
+            result.camera.c_str(), resolution.c_str(), result.format.c_str(),
+            result.fps, result.drop_rate * 100., result.delivered_fps, result.bytes_per_frame / 1000., result.decode_ms
+        );
+    }
+}
+
+static auto json_string(std::string const& str) -> std::string
+{
+    auto res = std::string{"\""};
+    for (char const c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            res += '\\';
+            res += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+            res += escaped;
+        }
+        else
+        {
+            res += c;
+        }
+    }
+    return res + "\"";
+}
+
+static void write_json(std::vector<ModeResult> const& results, std::FILE* file)
+{
+    std::fprintf(file, "[\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto const& result = results[i];
+        std::fprintf(file, "  {\"camera\": %s, \"width\": %u, \"height\": %u, ", json_string(result.camera).c_str(), result.resolution.width(), result.resolution.height());
+        if (result.error)
+        {
+            std::fprintf(file, "\"error\": %s}", json_string(*result.error).c_str());
+        }
+        else
+        {
+            std::fprintf(
+                file,
+                "\"format\": %s, \"frames_count\": %zu, \"fps\": %.3f, \"drop_rate\": %.4f, \"delivered_fps\": %.3f, \"bytes_per_frame\": %.0f, \"decode_ms\": %.3f}",
+                json_string(result.format).c_str(), result.frames_count, result.fps, result.drop_rate, result.delivered_fps, result.bytes_per_frame, result.decode_ms
+            );
+        }
+        std::fprintf(file, "%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "]\n");
+}
+
+static auto parse_options(int argc, char** argv) -> std::optional<Options>
+{
+    auto options = Options{};
+    for (int i = 1; i < argc; ++i)
+    {
+        auto const arg = std::string{argv[i]}; // NOLINT(*pointer-arithmetic)
+        if (arg == "--seconds" && i + 1 < argc)
+            options.duration = std::chrono::milliseconds{static_cast<int64_t>(std::atof(argv[++i]) * 1000.)}; // NOLINT(*pointer-arithmetic)
+        else if (arg == "--json" && i + 1 < argc)
+            options.json_path = argv[++i]; // NOLINT(*pointer-arithmetic)
+        else
+            return std::nullopt;
+    }
+    if (options.duration <= 0ms)
+        return std::nullopt;
+    return options;
+}
+
+auto main(int argc, char** argv) -> int
+{
+    auto const options = parse_options(argc, argv);
+    if (!options)
+    {
+        std::fprintf(stderr, "Usage: wcam-probe [--seconds N] [--json path]\n");
+        return 1;
+    }
+
+    wcam::set_image_type<Image>(); // Must be called before using anything from the library
+    auto const keep_wcam_alive = wcam::KeepLibraryAlive{};
+    std::this_thread::sleep_for(1s); // Gives the library some time to list the cameras
+
+    auto results = std::vector<ModeResult>{};
+    for (auto const& info : wcam::all_webcams_info())
+    {
+        auto webcam_results = probe_webcam(info, *options);
+        results.insert(results.end(), webcam_results.begin(), webcam_results.end());
+    }
+    if (results.empty())
+        std::fprintf(stderr, "No camera found\n");
+
+    print_table(results);
+    if (!options->json_path)
+    {
+        std::printf("\n");
+        write_json(results, stdout);
+        return 0;
+    }
+    auto* const file = std::fopen(options->json_path->c_str(), "w"); // NOLINT(*owning-memory)
+    if (!file)
+    {
+        std::fprintf(stderr, "Failed to open \"%s\"\n", options->json_path->c_str());
+        return 1;
+    }
+    write_json(results, file);
+    std::fclose(file); // NOLINT(*owning-memory)
+    return 0;
+}
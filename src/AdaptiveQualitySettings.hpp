@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include "Resolution.hpp"
+
+namespace wcam {
+
+/// When the machine is overloaded and we can't keep up with the frame rate of the camera, we can progressively make the capture cheaper.
+/// We first skip frames, then decode MJPEG frames at a lower resolution, and then capture at a lower resolution. We restore the quality once there is headroom again.
+/// The fields of this struct are the bounds that you allow us to go to.
+struct AdaptiveQualitySettings {
+    bool                      enabled{false};
+    uint32_t                  max_frames_skipped{1};         /// Max number of frames that we drop after each frame that we decode. 1 means that we can go down to half the frame rate of the camera.
+    uint32_t                  max_jpeg_scale_denominator{4}; /// MJPEG frames can be decoded at 1/2, 1/4 or 1/8 of their resolution, which is a lot cheaper. 1 means that we never do it.
+    std::optional<Resolution> min_resolution{};              /// If set, we can capture at a lower resolution than the selected one (but never lower than this one). The aspect ratio is always preserved.
+    std::optional<float>      max_cpu_pressure{};            /// Linux only. If set, we also reduce the quality when the percentage of time some tasks spent waiting for a CPU (as reported by /proc/pressure/cpu) goes above that threshold, even if we are keeping up ourselves.
+};
+
+} // namespace wcam
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+#include "FrameMetadata.hpp"
+#include "Image.hpp"
+#include "MaybeImage.hpp"
+#include "PooledBuffer.hpp"
+#include "Resolution.hpp"
+
+namespace wcam {
+
+/// Implemented by wcam: this is how the capture of a Backend gives its frames to wcam.
+/// They then go through the same path as the frames of the native cameras (consumers, pipelines, virtual cameras, etc.).
+/// All the functions can be called from any thread, but you should call them from a single thread per capture.
+class FrameSink {
+public:
+    FrameSink()                                        = default;
+    virtual ~FrameSink()                               = default;
+    FrameSink(FrameSink const&)                        = delete;
+    auto operator=(FrameSink const&) -> FrameSink&     = delete;
+    FrameSink(FrameSink&&) noexcept                    = delete;
+    auto operator=(FrameSink&&) noexcept -> FrameSink& = delete;
+
+    /// Returns false when none of the consumers wants a new frame yet (because they all have a max fps), in which case you should drop the frame before decoding it
+    [[nodiscard]] virtual auto is_frame_wanted() -> bool = 0;
+    /// Memory from wcam's buffer pool, which is counted in the memory usage of the camera (see memory_usage())
+    [[nodiscard]] virtual auto acquire_buffer(size_t size) -> PooledBuffer = 0;
+    /// Creates the image that you must fill (with one of the Image::set_data() functions) and then give to publish_image()
+    [[nodiscard]] virtual auto make_image() -> std::shared_ptr<Image> = 0;
+    virtual void               publish_image(std::shared_ptr<Image> image, FrameMetadata) = 0;
+    /// The consumers will see this error, and we will then destroy the capture and call Backend::open() again, like we do for the native cameras
+    virtual void               publish_error(CaptureError) = 0;
+};
+
+/// A capture started by Backend::open(). Its destructor must stop the capture, and must make sure that the FrameSink is not used anymore once it returns.
+class BackendCapture {
+public:
+    BackendCapture()                                             = default;
+    virtual ~BackendCapture()                                    = default;
+    BackendCapture(BackendCapture const&)                        = delete;
+    auto operator=(BackendCapture const&) -> BackendCapture&     = delete;
+    BackendCapture(BackendCapture&&) noexcept                    = delete;
+    auto operator=(BackendCapture&&) noexcept -> BackendCapture& = delete;
+};
+
+struct BackendWebcamInfo {
+    std::string             name{};        /// Name that can be displayed in the UI
+    std::string             id{};          /// Must be unique among the cameras of the backend, and stay the same as long as the camera is available
+    std::vector<Resolution> resolutions{}; /// Lists all the resolutions that the camera can produce
+};
+
+using MaybeBackendCapture = std::variant<std::unique_ptr<BackendCapture>, CaptureError>;
+
+/// A source of cameras that wcam doesn't support natively, e.g. a GigE SDK, an RTSP stream or a test pattern. See register_backend().
+class Backend {
+public:
+    Backend()                                      = default;
+    virtual ~Backend()                             = default;
+    Backend(Backend const&)                        = delete;
+    auto operator=(Backend const&) -> Backend&     = delete;
+    Backend(Backend&&) noexcept                    = delete;
+    auto operator=(Backend&&) noexcept -> Backend& = delete;
+
+    /// Called regularly on the Manager thread, so it should be reasonably fast
+    [[nodiscard]] virtual auto webcams_infos() -> std::vector<BackendWebcamInfo> = 0;
+    /// Called on the Manager thread. `id` is one of the ids returned by webcams_infos(), and `resolution` one of its resolutions.
+    /// The sink stays alive as long as the returned capture. If you return an error, we will call open() again a bit later.
+    [[nodiscard]] virtual auto open(std::string const& id, Resolution resolution, FrameSink& sink) -> MaybeBackendCapture = 0;
+};
+
+} // namespace wcam
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace wcam {
+
+/// The order of the colors in the top-left 2x2 block of a Bayer image. e.g. RGGB means that the first row starts with Red, Green and the second row with Green, Blue.
+enum class BayerPattern {
+    RGGB,
+    BGGR,
+    GRBG,
+    GBRG,
+};
+
+enum class DemosaicMethod {
+    Bilinear,   /// Each missing color is the average of its closest neighbours of that color
+    EdgeAware,  /// Same as Bilinear, but green is interpolated along edges instead of across them, which reduces the colored zippers on sharp edges. Slightly more expensive.
+    Superpixel, /// Each 2x2 block gives one pixel, so the image has half the width and half the height of the sensor. Very cheap, and has no interpolation artifacts, which makes it great for previews.
+};
+
+enum class DemosaicOutput {
+    RGB24,
+    RGBA32, /// Alpha is always 255. Convenient to upload to the GPU.
+    GRAY8,  /// The luminance of the demosaiced image
+};
+
+/// Bayer cameras (typically industrial ones) send the raw data of their sensor, where each pixel only has one of the three colors.
+/// We reconstruct the full color image on the CPU, as described by those settings. Only used on Linux, since this is the only platform where we capture Bayer formats.
+struct BayerSettings {
+    DemosaicMethod method{DemosaicMethod::Bilinear};
+    DemosaicOutput output{DemosaicOutput::RGB24};
+};
+
+} // namespace wcam
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <variant>
+#include <vector>
+#include "History.hpp"
+#include "MaybeImage.hpp"
+
+namespace wcam {
+
+struct BurstFrame {
+    uint32_t     sequence{}; /// The number given to the frame by the driver. Consecutive frames have consecutive numbers, so a gap means that the camera or the driver dropped some frames.
+    HistoryFrame frame{};    /// The frame exactly as the camera sent it. Use decode_history() if you need it as an Image.
+};
+
+/// The result of SharedWebcam::capture_burst()
+using MaybeBurst = std::variant<std::vector<BurstFrame>, CaptureError>;
+
+} // namespace wcam
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace wcam {
+
+/// Some capture cards and virtual cameras send the exact same frame again and again when their source is static.
+/// We can detect those duplicates by looking at the raw data sent by the camera, before decoding it.
+enum class DuplicateFramesPolicy {
+    Deliver,     /// Every frame is decoded and delivered, even if it is identical to the previous one
+    SkipExact,   /// Frames whose data is identical to the previous one are dropped before being decoded. SharedWebcam::image() keeps returning the previous image, so you can tell that nothing changed by comparing the pointer with the one you got last time, and skip your own uploads / processing.
+    SkipSampled, /// Same as SkipExact, but only compares a sample of the data, which is even cheaper. A frame that only changed outside of the sampled bytes will be considered a duplicate.
+};
+
+} // namespace wcam
@@ -0,0 +1,14 @@
+#pragma once
+#include <chrono>
+#include <optional>
+
+namespace wcam {
+
+/// Information about a frame, filled by wcam before it gives you the image
+struct FrameMetadata {
+    std::chrono::steady_clock::time_point                timestamp{};        /// When the frame was captured. On Linux this is the timestamp given by the driver, which is comparable across cameras. On Windows it is the time at which we received the frame.
+    std::optional<std::chrono::steady_clock::time_point> device_timestamp{}; /// Only set when hardware timestamps are enabled (see HardwareTimestampsSettings), on Linux. When the camera captured the frame, according to its own clock, converted to ours. More precise than `timestamp`, and `timestamp - *device_timestamp` is the latency of the transfer.
+    std::optional<float>                                 motion_score{};     /// Only set when the motion gate is enabled (see MotionGateSettings). Between 0 (nothing moved) and 1 (everything changed), compared to the previous frame that was published.
+};
+
+} // namespace wcam
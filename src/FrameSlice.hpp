@@ -0,0 +1,24 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "Resolution.hpp"
+
+namespace wcam {
+
+/// A horizontal band of a frame that has just been decoded, while the rest of the frame is still being decoded. See SharedWebcam::set_slice_callback().
+struct FrameSlice {
+    std::shared_ptr<uint8_t const>        rgb_data;    /// The whole frame, in RGB24, with the first row at the top. Only the rows before `first_row + rows_count` have been written yet. This is the very buffer that will then be given to Image::set_data(), so you can keep it alive to avoid a copy.
+    Resolution                            resolution;  /// Of the whole frame
+    uint32_t                              first_row;   /// The rows that have just been decoded are the ones in [first_row, first_row + rows_count)
+    uint32_t                              rows_count;
+    std::chrono::steady_clock::time_point timestamp{}; /// Same as the one of the FrameMetadata of the image. Allows you to know which frame the slice belongs to.
+
+    [[nodiscard]] auto is_last_slice() const -> bool { return first_row + rows_count == resolution.height(); }
+};
+
+/// Called on the capture thread, so it must be cheap, otherwise it will delay the rest of the frame
+using SliceCallback = std::function<void(FrameSlice const&)>;
+
+} // namespace wcam
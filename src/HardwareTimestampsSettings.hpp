@@ -0,0 +1,12 @@
+#pragma once
+
+namespace wcam {
+
+/// When enabled, we read the timestamps that UVC cameras put in the header of each frame, and convert them to our clock (see FrameMetadata::device_timestamp).
+/// They tell when the camera actually captured the frame, without the jitter of the USB transfer and of the driver, which allows for much tighter synchronisation between cameras.
+/// Only supported on Linux, with cameras that expose a metadata node (which is the case of most UVC cameras since Linux 4.16). Changing it restarts the capture.
+struct HardwareTimestampsSettings {
+    bool enabled{false};
+};
+
+} // namespace wcam
@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "FirstRowIs.hpp"
+#include "Resolution.hpp"
+
+namespace wcam {
+
+/// Keeps the last few seconds of frames of a camera, so that when an event happens you can get what happened right before it.
+/// We store the frames exactly as the camera sent them, before decoding them: MJPEG frames are about 10 times smaller than the decoded image, which makes long histories affordable.
+/// Frames that the camera sends uncompressed (e.g. YUYV) are stored as is, so they use a lot more memory.
+struct HistorySettings {
+    bool                      enabled{false};
+    std::chrono::milliseconds duration{5000};        /// Frames older than that are discarded
+    size_t                    max_bytes{64'000'000}; /// The oldest frames are discarded when the history would use more memory than that
+};
+
+/// The format of the data stored in a HistoryFrame
+enum class HistoryFrameFormat {
+    MJPEG,
+    YUYV,
+    BGR24,
+    NV12,
+    I420,
+    BayerRGGB8,
+    BayerBGGR8,
+    BayerGRBG8,
+    BayerGBRG8,
+    BayerRGGB10P, /// 10 bits per pixel, packed as 4 pixels in 5 bytes (the MIPI CSI-2 RAW10 layout)
+    BayerBGGR10P,
+    BayerGRBG10P,
+    BayerGBRG10P,
+    GRAY8,
+    GRAY16,  /// 16 bits per pixel, little-endian
+    GRAY10,  /// 10 bits per pixel, stored in the least significant bits of 16-bit little-endian values
+    GRAY10P, /// 10 bits per pixel, packed as 4 pixels in 5 bytes (the MIPI CSI-2 RAW10 layout)
+};
+
+struct HistoryFrame {
+    std::chrono::steady_clock::time_point timestamp{}; /// When the frame was captured (see FrameMetadata::timestamp)
+    HistoryFrameFormat                    format{};
+    Resolution                            resolution{};
+    FirstRowIs                            row_order{FirstRowIs::Top};
+    std::shared_ptr<uint8_t const>        data{}; /// The frame as it was sent by the camera. Shared between all the copies of the frame, so extracting the history doesn't copy the frames.
+    size_t                                data_size{0};
+};
+
+} // namespace wcam
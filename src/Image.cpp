@@ -1,6 +1,9 @@
 #include "Image.hpp"
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include "internal/BufferPool.hpp"
+#include "internal/yuyv_to_rgb.hpp"
 
 namespace wcam {
 
@@ -11,7 +14,7 @@ static auto clamp(int x) -> int
 
 static auto BGR24_to_RGB24(uint8_t const* bgr_data, Resolution resolution) -> std::shared_ptr<uint8_t const>
 {
-    auto       rgb_data = std::shared_ptr<uint8_t>{new uint8_t[resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
+    auto       rgb_data = internal::buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
     auto const width    = resolution.width();
     auto const height   = resolution.height();
 
@@ -28,26 +31,23 @@ static auto BGR24_to_RGB24(uint8_t const* bgr_data, Resolution resolution) -> st
     return rgb_data;
 }
 
-static auto NV12_to_RGB24(uint8_t const* nv12Data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+/// `chroma_step` is the distance between two consecutive U (or V) values: 2 when they are interleaved (NV12), 1 when they have their own planes (I420)
+static auto YUV420_to_RGB24(ImagePlane luma, ImagePlane u, ImagePlane v, size_t chroma_step, Resolution resolution) -> std::shared_ptr<uint8_t const>
 {
-    auto       rgb_data   = std::shared_ptr<uint8_t>{new uint8_t[resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-    auto const frame_size = resolution.pixels_count();
-    auto const width      = resolution.width();
-    auto const height     = resolution.height();
-
-    uint8_t const* const y_plane  = nv12Data;
-    uint8_t const* const uv_plane = nv12Data + frame_size; // NOLINT(*pointer-arithmetic)
+    auto       rgb_data = internal::buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
+    auto const width    = resolution.width();
+    auto const height   = resolution.height();
 
     for (Resolution::DataType y = 0; y < height; y++)
     {
+        uint8_t const* const y_row = luma.data + y * luma.bytes_per_row;  // NOLINT(*pointer-arithmetic)
+        uint8_t const* const u_row = u.data + (y / 2) * u.bytes_per_row; // NOLINT(*pointer-arithmetic)
+        uint8_t const* const v_row = v.data + (y / 2) * v.bytes_per_row; // NOLINT(*pointer-arithmetic)
         for (Resolution::DataType x = 0; x < width; x++)
         {
-            auto const y_index  = y * width + x;
-            auto const uv_index = (y / 2) * (width / 2) + (x / 2);
-
-            uint8_t const Y = y_plane[y_index];                            // NOLINT(*pointer-arithmetic)
-            uint8_t const U = uv_plane[static_cast<size_t>(uv_index * 2)]; // NOLINT(*pointer-arithmetic)
-            uint8_t const V = uv_plane[uv_index * 2 + 1];                  // NOLINT(*pointer-arithmetic)
+            uint8_t const Y = y_row[x];                     // NOLINT(*pointer-arithmetic)
+            uint8_t const U = u_row[(x / 2) * chroma_step]; // NOLINT(*pointer-arithmetic)
+            uint8_t const V = v_row[(x / 2) * chroma_step]; // NOLINT(*pointer-arithmetic)
 
             int const C = Y - 16;
             int const D = U - 128;
@@ -66,34 +66,66 @@ static auto NV12_to_RGB24(uint8_t const* nv12Data, Resolution resolution) -> std
     return rgb_data;
 }
 
+static auto NV12_to_RGB24(uint8_t const* nv12Data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+{
+    auto const luma     = ImagePlane{nv12Data, resolution.width()};
+    auto const uv_plane = ImagePlane{nv12Data + resolution.pixels_count(), resolution.width()}; // NOLINT(*pointer-arithmetic)
+    return YUV420_to_RGB24(luma, uv_plane, {uv_plane.data + 1, uv_plane.bytes_per_row}, 2, resolution); // NOLINT(*pointer-arithmetic)
+}
+
 static auto YUYV_to_RGB24(uint8_t const* yuyv, Resolution resolution) -> std::shared_ptr<uint8_t const>
 {
-    auto rgb_data = std::shared_ptr<uint8_t>{new uint8_t[resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-    for (uint64_t i = 0; i < resolution.pixels_count() * 2; i += 4)
+    auto rgb_data = internal::buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
+    internal::yuyv_to_rgb(yuyv, rgb_data.get(), resolution, 0, resolution.height());
+    return rgb_data;
+}
+
+static auto RGBA32_to_RGB24(uint8_t const* rgba_data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+{
+    auto rgb_data = internal::buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
+    for (uint64_t i = 0; i < resolution.pixels_count(); ++i)
     {
-        auto const y0 = static_cast<int>(yuyv[i + 0] << 8);  // NOLINT(*pointer-arithmetic)
-        auto const u  = static_cast<int>(yuyv[i + 1] - 128); // NOLINT(*pointer-arithmetic)
-        auto const y1 = static_cast<int>(yuyv[i + 2] << 8);  // NOLINT(*pointer-arithmetic)
-        auto const v  = static_cast<int>(yuyv[i + 3] - 128); // NOLINT(*pointer-arithmetic)
-
-        int const r0 = (y0 + 359 * v) >> 8;
-        int const g0 = (y0 - 88 * u - 183 * v) >> 8;
-        int const b0 = (y0 + 454 * u) >> 8;
-        int const r1 = (y1 + 359 * v) >> 8;
-        int const g1 = (y1 - 88 * u - 183 * v) >> 8;
-        int const b1 = (y1 + 454 * u) >> 8;
-
-        rgb_data.get()[i * 3 / 2 + 0] = static_cast<uint8_t>(std::clamp(r0, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 1] = static_cast<uint8_t>(std::clamp(g0, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 2] = static_cast<uint8_t>(std::clamp(b0, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 3] = static_cast<uint8_t>(std::clamp(r1, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 4] = static_cast<uint8_t>(std::clamp(g1, 0, 255)); // NOLINT(*pointer-arithmetic)
-        rgb_data.get()[i * 3 / 2 + 5] = static_cast<uint8_t>(std::clamp(b1, 0, 255)); // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 0] = rgba_data[i * 4 + 0]; // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 1] = rgba_data[i * 4 + 1]; // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 2] = rgba_data[i * 4 + 2]; // NOLINT(*pointer-arithmetic)
     }
+    return rgb_data;
+}
 
+static auto GRAY8_to_RGB24(uint8_t const* gray_data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+{
+    auto rgb_data = internal::buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
+    for (uint64_t i = 0; i < resolution.pixels_count(); ++i)
+    {
+        rgb_data.get()[i * 3 + 0] = gray_data[i]; // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 1] = gray_data[i]; // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 2] = gray_data[i]; // NOLINT(*pointer-arithmetic)
+    }
     return rgb_data;
 }
 
+static auto GRAY16_to_RGB24(uint8_t const* gray_data, Resolution resolution) -> std::shared_ptr<uint8_t const>
+{
+    auto rgb_data = internal::buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
+    for (uint64_t i = 0; i < resolution.pixels_count(); ++i)
+    {
+        auto value = uint16_t{};
+        std::memcpy(&value, gray_data + i * 2, sizeof(value)); // NOLINT(*pointer-arithmetic)
+        auto const gray           = static_cast<uint8_t>(value >> 8);
+        rgb_data.get()[i * 3 + 0] = gray; // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 1] = gray; // NOLINT(*pointer-arithmetic)
+        rgb_data.get()[i * 3 + 2] = gray; // NOLINT(*pointer-arithmetic)
+    }
+    return rgb_data;
+}
+
+namespace internal {
+void set_frame_metadata(Image& image, FrameMetadata metadata)
+{
+    image._metadata = std::move(metadata);
+}
+} // namespace internal
+
 void Image::set_data(ImageDataView<BGR24> const& bgrData)
 {
     set_data(ImageDataView<RGB24>{
@@ -124,4 +156,60 @@ void Image::set_data(ImageDataView<YUYV> const& yuyv_data)
     });
 }
 
-} // namespace wcam
\ No newline at end of file
+void Image::set_data(ImageDataView<RGBA32> const& rgba_data)
+{
+    set_data(ImageDataView<RGB24>{
+        RGBA32_to_RGB24(rgba_data.data(), rgba_data.resolution()),
+        RGB24::data_length(rgba_data.resolution()),
+        rgba_data.resolution(),
+        rgba_data.row_order()
+    });
+}
+
+void Image::set_data(ImageDataView<GRAY8> const& gray_data)
+{
+    set_data(ImageDataView<RGB24>{
+        GRAY8_to_RGB24(gray_data.data(), gray_data.resolution()),
+        RGB24::data_length(gray_data.resolution()),
+        gray_data.resolution(),
+        gray_data.row_order()
+    });
+}
+
+void Image::set_data(ImageDataView<GRAY16> const& gray_data)
+{
+    set_data(ImageDataView<RGB24>{
+        GRAY16_to_RGB24(gray_data.data(), gray_data.resolution()),
+        RGB24::data_length(gray_data.resolution()),
+        gray_data.resolution(),
+        gray_data.row_order()
+    });
+}
+
+void Image::set_data(ImagePlanesView<NV12> const& nv12_planes)
+{
+    if (nv12_planes.is_contiguous())
+    {
+        set_data(ImageDataView<NV12>{nv12_planes.plane(0).data, NV12::data_length(nv12_planes.resolution()), nv12_planes.resolution(), nv12_planes.row_order()});
+        return;
+    }
+    auto const uv_plane = nv12_planes.plane(1);
+    set_data(ImageDataView<RGB24>{
+        YUV420_to_RGB24(nv12_planes.plane(0), uv_plane, {uv_plane.data + 1, uv_plane.bytes_per_row}, 2, nv12_planes.resolution()), // NOLINT(*pointer-arithmetic)
+        RGB24::data_length(nv12_planes.resolution()),
+        nv12_planes.resolution(),
+        nv12_planes.row_order()
+    });
+}
+
+void Image::set_data(ImagePlanesView<I420> const& i420_planes)
+{
+    set_data(ImageDataView<RGB24>{
+        YUV420_to_RGB24(i420_planes.plane(0), i420_planes.plane(1), i420_planes.plane(2), 1, i420_planes.resolution()),
+        RGB24::data_length(i420_planes.resolution()),
+        i420_planes.resolution(),
+        i420_planes.row_order()
+    });
+}
+
+} // namespace wcam
@@ -1,10 +1,12 @@
 #pragma once
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <utility>
 #include <variant>
 #include "FirstRowIs.hpp"
+#include "FrameMetadata.hpp"
 #include "Resolution.hpp"
 #include "overloaded.hpp"
 
@@ -17,6 +19,28 @@ struct RGB24 {
     }
 };
 
+struct RGBA32 {
+    static auto data_length(Resolution resolution) -> size_t
+    {
+        return resolution.pixels_count() * 4;
+    }
+};
+
+struct GRAY8 {
+    static auto data_length(Resolution resolution) -> size_t
+    {
+        return resolution.pixels_count();
+    }
+};
+
+/// 16 bits per pixel, in the native endianness. Typically used by depth cameras (where the value is the distance in millimeters), and by infrared / machine vision cameras that have more than 8 bits of precision.
+struct GRAY16 {
+    static auto data_length(Resolution resolution) -> size_t
+    {
+        return resolution.pixels_count() * 2;
+    }
+};
+
 struct BGR24 {
     static auto data_length(Resolution resolution) -> size_t
     {
@@ -24,11 +48,40 @@ struct BGR24 {
     }
 };
 
+/// Y plane, followed by a plane where U and V are interleaved (both subsampled by 2 in each direction)
 struct NV12 {
+    static constexpr size_t planes_count = 2;
+
     static auto data_length(Resolution resolution) -> size_t
     {
         return resolution.pixels_count() * 3 / 2;
     }
+    static auto plane_row_size(size_t /* plane */, Resolution resolution) -> size_t
+    {
+        return resolution.width();
+    }
+    static auto plane_rows_count(size_t plane, Resolution resolution) -> size_t
+    {
+        return plane == 0 ? resolution.height() : resolution.height() / 2;
+    }
+};
+
+/// Y plane, followed by the U plane and then the V plane (both subsampled by 2 in each direction). Also known as YUV420 or YU12.
+struct I420 {
+    static constexpr size_t planes_count = 3;
+
+    static auto data_length(Resolution resolution) -> size_t
+    {
+        return resolution.pixels_count() * 3 / 2;
+    }
+    static auto plane_row_size(size_t plane, Resolution resolution) -> size_t
+    {
+        return plane == 0 ? resolution.width() : resolution.width() / 2;
+    }
+    static auto plane_rows_count(size_t plane, Resolution resolution) -> size_t
+    {
+        return plane == 0 ? resolution.height() : resolution.height() / 2;
+    }
 };
 
 struct YUYV {
@@ -109,6 +162,51 @@ private:
     wcam::FirstRowIs                                             _row_order{};
 };
 
+struct ImagePlane {
+    uint8_t const* data{};
+    size_t         bytes_per_row{}; /// Might be bigger than the size of the row, when the driver adds some padding at the end of each row
+};
+
+/// An image whose planes don't have to be contiguous in memory, e.g. because the driver gives us each plane in its own buffer.
+/// Like ImageDataView, it points to memory owned by wcam, so you must copy the data if you need it after set_data() returns.
+template<typename PixelFormatT>
+class ImagePlanesView {
+public:
+    ImagePlanesView(std::array<ImagePlane, PixelFormatT::planes_count> planes, Resolution resolution, wcam::FirstRowIs row_order)
+        : _planes{planes}
+        , _resolution{resolution}
+        , _row_order{row_order}
+    {}
+
+    auto plane(size_t index) const -> ImagePlane const& { return _planes[index]; } // NOLINT(*constant-array-index)
+    auto resolution() const -> Resolution { return _resolution; }
+    auto row_order() const -> wcam::FirstRowIs { return _row_order; }
+
+    /// True iff the planes follow each other in memory, without any padding. The image can then also be read as an ImageDataView starting at `plane(0).data`.
+    auto is_contiguous() const -> bool
+    {
+        auto const* expected_data = _planes[0].data;
+        for (size_t i = 0; i < PixelFormatT::planes_count; ++i)
+        {
+            auto const row_size = PixelFormatT::plane_row_size(i, _resolution);
+            if (_planes[i].data != expected_data || _planes[i].bytes_per_row != row_size) // NOLINT(*constant-array-index)
+                return false;
+            expected_data += row_size * PixelFormatT::plane_rows_count(i, _resolution); // NOLINT(*pointer-arithmetic)
+        }
+        return true;
+    }
+
+private:
+    std::array<ImagePlane, PixelFormatT::planes_count> _planes{};
+    Resolution                                         _resolution{};
+    wcam::FirstRowIs                                   _row_order{};
+};
+
+class Image;
+namespace internal {
+void set_frame_metadata(Image&, FrameMetadata);
+}
+
 class Image {
 public:
     Image()                                    = default;
@@ -122,6 +220,18 @@ public:
     virtual void set_data(ImageDataView<BGR24> const&);
     virtual void set_data(ImageDataView<NV12> const&);
     virtual void set_data(ImageDataView<YUYV> const&);
+    virtual void set_data(ImageDataView<RGBA32> const&);
+    virtual void set_data(ImageDataView<GRAY8> const&);
+    virtual void set_data(ImageDataView<GRAY16> const&); /// By default only keeps the 8 most significant bits
+    virtual void set_data(ImagePlanesView<NV12> const&); /// By default forwards to the ImageDataView<NV12> version when the planes are contiguous, and converts to RGB24 otherwise
+    virtual void set_data(ImagePlanesView<I420> const&);
+
+    /// Information about the frame, filled by wcam before it gives you the image
+    auto metadata() const -> FrameMetadata const& { return _metadata; }
+
+private:
+    friend void internal::set_frame_metadata(Image&, FrameMetadata);
+    FrameMetadata _metadata{};
 };
 
 } // namespace wcam
\ No newline at end of file
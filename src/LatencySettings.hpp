@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+
+namespace wcam {
+
+/// The driver keeps a queue of buffers that the camera fills, and gives them back to us from the oldest to the most recent.
+/// So when we are slower than the camera, the frames that we get are several frames old.
+/// Only supported on Linux.
+struct LatencySettings {
+    bool   low_latency{false}; /// Each time we get a frame, we also take all the other frames that are already waiting in the queue, and only keep the most recent one. The older ones are given back to the driver without being decoded (nor recorded in the history).
+    size_t buffers_count{6};   /// The number of buffers in the queue, between 2 and 32. Fewer buffers means less latency, more buffers means fewer dropped frames when we are occasionally slow. Changing it restarts the capture.
+};
+
+} // namespace wcam
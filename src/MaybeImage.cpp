@@ -1,4 +1,5 @@
 #include "MaybeImage.hpp"
+#include <fmt/format.h>
 #include "overloaded.hpp"
 
 namespace wcam {
@@ -14,6 +15,13 @@ auto to_string(CaptureError const& err) -> std::string
             [](Error_WebcamUnplugged const&) {
                 return "The camera has been unplugged. You need to re-plug it in."s;
             },
+            [](Error_NotEnoughUsbBandwidth const& err) {
+                return fmt::format(
+                    "There is not enough USB bandwidth left to start the camera: it needs about {:.1f} MB/s, but only {:.1f} MB/s are available on its USB bus. You can select a lower resolution, stop another camera that is plugged on the same USB controller, or plug this camera on another USB port (ideally one that is on another USB controller).",
+                    static_cast<double>(err.required_bytes_per_second) / 1'000'000.,
+                    static_cast<double>(err.available_bytes_per_second) / 1'000'000.
+                );
+            },
             [](Error_Unknown const& err) {
                 return "Unexpected error: "s + err.message;
             },
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <variant>
 #include "Image.hpp"
@@ -7,6 +8,10 @@ namespace wcam {
 
 struct Error_WebcamAlreadyUsedInAnotherApplication {};
 struct Error_WebcamUnplugged {};
+struct Error_NotEnoughUsbBandwidth {
+    uint64_t required_bytes_per_second{};  /// Estimation of the bandwidth needed by the cheapest mode that the camera offers at the selected resolution
+    uint64_t available_bytes_per_second{}; /// Bandwidth that is left on the USB bus of the camera, once the other cameras that we capture on the same bus are taken into account
+};
 struct Error_Unknown {
     std::string message;
 };
@@ -14,6 +19,7 @@ struct Error_Unknown {
 using CaptureError = std::variant<
     Error_WebcamAlreadyUsedInAnotherApplication,
     Error_WebcamUnplugged,
+    Error_NotEnoughUsbBandwidth,
     Error_Unknown>;
 
 auto to_string(CaptureError const&) -> std::string;
@@ -0,0 +1,33 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace wcam {
+
+/// What we do with a new frame when decoding it would exceed the memory budget
+enum class MemoryBudgetPolicy {
+    Drop,    /// Drop the frame before decoding it. Consumers keep seeing the previous frame.
+    Degrade, /// Decode MJPEG frames at a lower resolution (1/2, 1/4 or 1/8) so that they fit. Frames that can't be made small enough are dropped.
+    Block,   /// Wait until some memory is freed (for at most `max_block_duration`), and drop the frame if it still doesn't fit. While we wait, the camera's buffers are not given back to the driver, which slows down the capture.
+};
+
+/// Limits the memory that wcam's frame allocator hands out: the decoded frames and the outputs of the pipeline stages.
+/// Memory that your own Image type allocates in its set_data() is not accounted for.
+struct MemoryBudget {
+    std::optional<size_t>     max_bytes{}; /// std::nullopt means that there is no limit
+    MemoryBudgetPolicy        policy{MemoryBudgetPolicy::Drop};
+    std::chrono::milliseconds max_block_duration{100}; /// Only used by MemoryBudgetPolicy::Block
+};
+
+struct MemoryUsage {
+    size_t   bytes_in_use{0};      /// Memory held by frames and stage outputs that are still alive (e.g. because a consumer holds onto an image)
+    size_t   peak_bytes_in_use{0};
+    size_t   cached_bytes{0};      /// Only reported by the global usage: memory that is not in use anymore, but that we keep around to reuse it for the next frames. It counts towards the global budget, and is released first when we need room.
+    uint64_t frames_dropped{0};    /// Because of the budget
+    uint64_t frames_degraded{0};   /// Decoded at a lower resolution because of the budget
+    uint64_t frames_blocked{0};    /// Frames for which we had to wait for some memory to be freed
+};
+
+} // namespace wcam
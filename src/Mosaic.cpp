@@ -0,0 +1,67 @@
+#include "Mosaic.hpp"
+#include <algorithm>
+#include <limits>
+#include "internal/ImageFactory.hpp"
+#include "internal/MosaicState.hpp"
+#include "internal/WebcamRequest.hpp"
+
+namespace wcam {
+
+auto MosaicLayout::grid(Resolution tile_resolution, uint32_t columns_count, size_t tiles_count) -> MosaicLayout
+{
+    columns_count         = std::max(columns_count, 1u);
+    auto const rows_count = static_cast<uint32_t>((tiles_count + columns_count - 1) / columns_count);
+    auto       layout     = MosaicLayout{};
+    layout.resolution     = Resolution{tile_resolution.width() * std::min(columns_count, static_cast<uint32_t>(tiles_count)), tile_resolution.height() * rows_count};
+    for (size_t i = 0; i < tiles_count; ++i)
+    {
+        layout.tiles.push_back({
+            .x      = static_cast<uint32_t>(i % columns_count) * tile_resolution.width(),
+            .y      = static_cast<uint32_t>(i / columns_count) * tile_resolution.height(),
+            .width  = tile_resolution.width(),
+            .height = tile_resolution.height(),
+        });
+    }
+    return layout;
+}
+
+Mosaic::Mosaic(std::vector<SharedWebcam> webcams, MosaicLayout layout)
+    : _webcams{std::move(webcams)}
+    , _state{std::make_shared<internal::MosaicState>(std::move(layout))}
+{
+    auto const whole_frame = CropRegion{.x = 0, .y = 0, .width = std::numeric_limits<uint32_t>::max(), .height = std::numeric_limits<uint32_t>::max()}; // The tile receives the frame without any copy, and scales it itself
+    for (size_t i = 0; i < std::min(_webcams.size(), _state->layout().tiles.size()); ++i)
+    {
+        auto const weak_state = std::weak_ptr{_state};
+        auto       subscriber = std::make_shared<internal::CropSubscriber>(
+            whole_frame,
+            [weak_state]() { return !weak_state.expired(); },
+            [weak_state](MaybeImage const& image) {
+                auto const  state     = weak_state.lock();
+                auto const* new_image = std::get_if<std::shared_ptr<Image const>>(&image);
+                if (state && new_image) // When the camera is in error, its tile keeps its last frame
+                    state->on_tile_updated(*new_image);
+            },
+            [weak_state, i]() -> std::shared_ptr<Image> {
+                auto state = weak_state.lock();
+                if (!state) // The Mosaic has been destroyed in the meantime, the image will be thrown away
+                    return internal::image_factory().make_image();
+                return std::make_shared<internal::MosaicTileImage>(std::move(state), i);
+            }
+        );
+        _webcams[i]._request->subscriptions()->add_crop_subscriber(subscriber);
+        _state->keep_subscriber_alive(std::move(subscriber));
+    }
+}
+
+auto Mosaic::image() const -> MaybeImage
+{
+    return _state->image();
+}
+
+auto Mosaic::layout() const -> MosaicLayout const&
+{
+    return _state->layout();
+}
+
+} // namespace wcam
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MaybeImage.hpp"
+#include "Resolution.hpp"
+#include "SharedWebcam.hpp"
+
+namespace wcam {
+
+namespace internal {
+class MosaicState;
+}
+
+/// Where the images of a camera go in the mosaic, in pixels, with (0, 0) being the top-left corner of the mosaic
+struct MosaicTile {
+    uint32_t x{0};
+    uint32_t y{0};
+    uint32_t width{0};
+    uint32_t height{0};
+};
+
+struct MosaicLayout {
+    Resolution              resolution{}; /// Of the whole mosaic
+    std::vector<MosaicTile> tiles{};      /// One per camera, in the same order as the cameras given to the Mosaic. They must fit in the mosaic, and should not overlap.
+
+    /// `tiles_count` tiles of `tile_resolution`, laid out in rows of `columns_count` tiles
+    static auto grid(Resolution tile_resolution, uint32_t columns_count, size_t tiles_count) -> MosaicLayout;
+};
+
+/// Composites the images of several cameras into a single RGB24 image, e.g. for a monitoring wall.
+/// Each camera scales its frames directly into its tile of the mosaic, on its own capture thread, so a new frame only updates the tile of its camera, and nothing is converted twice.
+/// The frames are stretched to fill their tile (nearest neighbour), so you should pick tiles with the same aspect ratio as the cameras.
+class Mosaic {
+public:
+    Mosaic(std::vector<SharedWebcam> webcams, MosaicLayout layout);
+
+    /// ImageNotInitYet until one of the cameras gave us a frame. The tiles of the cameras that didn't give us any frame yet are black, and the ones of the cameras in error keep their last frame.
+    /// A new image is only created when one of the tiles changed since the last call, and its metadata is the one of the most recent frame it contains.
+    [[nodiscard]] auto image() const -> MaybeImage;
+
+    [[nodiscard]] auto webcams() const -> std::vector<SharedWebcam> const& { return _webcams; }
+    [[nodiscard]] auto layout() const -> MosaicLayout const&;
+
+private:
+    std::vector<SharedWebcam>              _webcams; // Keeps the captures alive
+    std::shared_ptr<internal::MosaicState> _state;
+};
+
+} // namespace wcam
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+namespace wcam {
+
+/// When enabled, frames are only decoded and published when something changed in the scene, compared to the last frame that was published.
+/// We compare a small downsampled version of the luminance, that we get without decoding the full frame, so static cameras cost almost nothing.
+/// The score of each published frame is available in its FrameMetadata.
+struct MotionGateSettings {
+    bool    enabled{false};
+    float   threshold{0.01f};    /// Between 0 and 1. Frames whose motion score is below that are dropped. The score is the fraction of the image that changed.
+    uint8_t luma_difference{12}; /// How much the luminance of a region needs to change (between 0 and 255) to consider that it moved. Increase it if your camera is noisy.
+};
+
+} // namespace wcam
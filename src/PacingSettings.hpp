@@ -0,0 +1,23 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace wcam {
+
+/// USB cameras capture their frames at a very regular rate, but deliver them with an irregular spacing, so a render loop that calls image() at each vsync sees some frames twice and skips others.
+/// Pacing delays each frame by a fixed amount after it was captured (according to FrameMetadata::device_timestamp when available, FrameMetadata::timestamp otherwise), so that image() gives you the frames exactly as regularly as the camera captured them.
+/// This works as long as the transfer of a frame varies by less than the delay. See PacingStats to check how much it varies in practice.
+struct PacingSettings {
+    bool  enabled{false};
+    float delay_in_frames{1.f}; /// Between 1 and 2 frame intervals. More delay absorbs more jitter (smoother), less delay gives you the frames sooner (less latency).
+};
+
+struct PacingStats {
+    std::chrono::microseconds frame_interval{0};       /// The interval between two frames, estimated from their timestamps
+    std::chrono::microseconds transfer_jitter{0};      /// How much the time between the capture and the arrival of a frame varies (mean absolute deviation). This is what the delay needs to absorb.
+    std::chrono::microseconds release_jitter{0};       /// How much the interval between two new frames returned by image() differs from `frame_interval` (mean absolute deviation). It also includes the irregularity of your own calls to image().
+    uint64_t                  late_frames_count{0};    /// Frames that arrived after the time at which they should have been released. If this keeps growing, you should increase the delay.
+    uint64_t                  skipped_frames_count{0}; /// Frames that image() never returned, because a newer one was already due by the time you called it
+};
+
+} // namespace wcam
@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Image.hpp"
+#include "PooledBuffer.hpp"
+
+namespace wcam {
+
+namespace internal {
+class PipelineRun;
+}
+
+/// Identifies a stage in the pipeline of a SharedWebcam
+using StageId = size_t;
+
+/// What a stage gets access to while it processes a frame
+class StageContext {
+public:
+    /// The frame, as it was published by the capture. This is the very same image as the one returned by SharedWebcam::image(), no copy is made.
+    [[nodiscard]] auto image() const -> Image const& { return _image; }
+    /// The output of one of the stages that this stage depends on. Empty if that stage failed.
+    [[nodiscard]] auto result_of(StageId) const -> PooledBuffer const&;
+    /// Gives you a buffer from wcam's pool, to store your output without allocating new memory for each frame
+    [[nodiscard]] auto make_buffer(size_t size) const -> PooledBuffer;
+
+private:
+    friend class internal::PipelineRun;
+    StageContext(Image const& image, std::vector<PooledBuffer> const& results, std::vector<StageId> const& dependencies)
+        : _image{image}
+        , _results{results}
+        , _dependencies{dependencies}
+    {}
+
+private:
+    Image const&                     _image;
+    std::vector<PooledBuffer> const& _results;
+    std::vector<StageId> const&      _dependencies;
+};
+
+/// Processes a frame, and returns its output (that can be read by the stages that depend on this one, and by SharedWebcam::stage_result()).
+/// Exceptions thrown by the stage are caught and counted as failures.
+using StageFunction = std::function<PooledBuffer(StageContext const&)>;
+
+struct StageMetrics {
+    std::string              name{};
+    uint64_t                 frames_count{0};   /// How many frames this stage has processed
+    uint64_t                 failures_count{0}; /// How many times this stage threw an exception
+    std::chrono::nanoseconds last_latency{0};
+    std::chrono::nanoseconds average_latency{0};
+    std::chrono::nanoseconds max_latency{0};
+};
+
+struct PipelineMetrics {
+    uint64_t                  frames_skipped{0}; /// Frames that arrived while the pipeline was still busy with the previous one. We skip them instead of queuing them, so that the latency doesn't grow.
+    std::vector<StageMetrics> stages{};          /// Indexed by StageId
+};
+
+} // namespace wcam
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace wcam {
+
+/// A chunk of memory that comes from wcam's buffer pool, and goes back to it once the last copy of the PooledBuffer is destroyed.
+/// Copies share the same memory, so passing them around never copies the data.
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    PooledBuffer(std::shared_ptr<uint8_t> data, size_t size)
+        : _data{std::move(data)}
+        , _size{size}
+    {}
+
+    [[nodiscard]] auto data() const -> uint8_t* { return _data.get(); }
+    [[nodiscard]] auto size() const -> size_t { return _size; }
+    [[nodiscard]] auto empty() const -> bool { return _size == 0; }
+    /// Allows you to keep the memory alive, e.g. to pass it to an ImageDataView
+    [[nodiscard]] auto shared_data() const -> std::shared_ptr<uint8_t> const& { return _data; }
+
+private:
+    std::shared_ptr<uint8_t> _data{};
+    size_t                   _size{0};
+};
+
+} // namespace wcam
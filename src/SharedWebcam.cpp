@@ -1,11 +1,12 @@
 #include "SharedWebcam.hpp"
+#include "internal/SnapshotWriter.hpp"
 #include "internal/WebcamRequest.hpp"
 
 namespace wcam {
 
 auto SharedWebcam::image() const -> MaybeImage
 {
-    return _request->image();
+    return _subscription->filter(_request->image());
 }
 
 auto SharedWebcam::id() const -> DeviceId
@@ -13,4 +14,64 @@ auto SharedWebcam::id() const -> DeviceId
     return _request->id();
 }
 
+void SharedWebcam::set_max_fps(std::optional<float> max_fps)
+{
+    _subscription->set_max_fps(max_fps);
+}
+
+auto SharedWebcam::max_fps() const -> std::optional<float>
+{
+    return _subscription->max_fps();
+}
+
+void SharedWebcam::set_pacing(PacingSettings settings)
+{
+    _subscription->pacer().set_settings(settings);
+}
+
+auto SharedWebcam::pacing() const -> PacingSettings
+{
+    return _subscription->pacer().settings();
+}
+
+auto SharedWebcam::pacing_stats() const -> PacingStats
+{
+    return _subscription->pacer().stats();
+}
+
+auto SharedWebcam::add_stage(std::string name, StageFunction function, std::vector<StageId> dependencies) -> StageId
+{
+    return _subscription->pipeline().add_stage(std::move(name), std::move(function), std::move(dependencies));
+}
+
+auto SharedWebcam::stage_result(StageId id) const -> PooledBuffer
+{
+    return _subscription->pipeline().result(id);
+}
+
+auto SharedWebcam::pipeline_metrics() const -> PipelineMetrics
+{
+    return _subscription->pipeline().metrics();
+}
+
+auto SharedWebcam::capture_still(Resolution resolution) const -> std::future<MaybeStill>
+{
+    return _request->request_still(resolution);
+}
+
+auto SharedWebcam::capture_burst(size_t frames_count, std::vector<PooledBuffer> buffers) const -> std::future<MaybeBurst>
+{
+    return _request->request_burst(frames_count, std::move(buffers));
+}
+
+auto SharedWebcam::save_snapshot(std::filesystem::path path, SnapshotCallback on_done, int jpeg_quality) const -> bool
+{
+    return internal::snapshot_writer().push([&]() { return _request->request_burst(1, {}); }, std::move(path), std::move(on_done), jpeg_quality);
+}
+
+void SharedWebcam::set_slice_callback(SliceCallback callback, uint32_t rows_per_slice)
+{
+    _subscription->set_slice_callback(std::move(callback), rows_per_slice);
+}
+
 } // namespace wcam
\ No newline at end of file
@@ -1,11 +1,26 @@
 #pragma once
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Burst.hpp"
 #include "DeviceId.hpp"
+#include "FrameSlice.hpp"
 #include "MaybeImage.hpp"
+#include "PacingSettings.hpp"
+#include "PipelineStage.hpp"
+#include "PooledBuffer.hpp"
+#include "Snapshot.hpp"
+#include "Still.hpp"
 
 namespace wcam {
 
 namespace internal {
 class Manager;
+class Subscription;
+class VirtualCaptureImpl;
 class WebcamRequest; // We must not include WebcamRequest in our public headers, because it would include Capture, which in turn includes a lot of platform-specific implementation details (and especially on Windows, it would include windows.h, which is an annoying header which can cause compilation issues if not included in the right order / with the right #defines)
 } // namespace internal
 
@@ -16,14 +31,64 @@ public:
     [[nodiscard]] auto image() const -> MaybeImage;
     [[nodiscard]] auto id() const -> DeviceId;
 
+    /// Caps the rate at which image() returns new images. Use std::nullopt to receive all the frames.
+    /// When all the consumers of a camera have a cap, the frames that none of them wants are dropped before being decoded, which saves a lot of CPU.
+    /// The camera then decodes frames at the highest of these caps, and each consumer can only pick among those. So the cap is only respected on average: e.g. with a 20 fps cap while another consumer has a 30 fps one, you get 20 images per second, but the time between two of them alternates between 1/15 s and 1/30 s.
+    void               set_max_fps(std::optional<float>);
+    [[nodiscard]] auto max_fps() const -> std::optional<float>;
+
+    /// Holds the frames for a short time, so that image() gives them to you at the same regular cadence at which the camera captured them. See PacingSettings for more details.
+    /// Only affects this SharedWebcam (and its copies), the other consumers of the camera still get the frames as soon as they arrive.
+    void               set_pacing(PacingSettings);
+    [[nodiscard]] auto pacing() const -> PacingSettings;
+    [[nodiscard]] auto pacing_stats() const -> PacingStats;
+
+    /// Registers a stage that will process each new frame in the background (at most at max_fps()), on a pool of worker threads.
+    /// A stage starts as soon as all the stages in `dependencies` are done, so independent stages run in parallel.
+    /// `dependencies` can only contain stages that have been added before this one.
+    auto               add_stage(std::string name, StageFunction, std::vector<StageId> dependencies = {}) -> StageId;
+    /// The output of the last frame that went through that stage
+    [[nodiscard]] auto stage_result(StageId) const -> PooledBuffer;
+    [[nodiscard]] auto pipeline_metrics() const -> PipelineMetrics;
+
+    /// Gives you each frame in horizontal slices of `rows_per_slice` rows, as soon as they are decoded, so that you can start working on the top of the frame while the rest is still being decoded.
+    /// The full image is still published as usual once it is complete. Use an empty callback to stop receiving slices.
+    /// If several consumers of the camera ask for slices, they all get the smallest slices that one of them asked for.
+    /// Only supported on Linux, for MJPEG and YUYV cameras. Note that the image you then get from image() is always RGB24, even if you overrode Image::set_data() for YUYV.
+    void               set_slice_callback(SliceCallback, uint32_t rows_per_slice = 64);
+
+    /// Captures a single frame at `resolution` (typically the full resolution of the sensor), without changing the selected resolution.
+    /// The stream is briefly switched to that resolution, and then switched back. In the meantime image() keeps returning the last image of the stream.
+    /// Only supported on Linux for now. On other platforms, the future contains an Error_Unknown.
+    [[nodiscard]] auto capture_still(Resolution) const -> std::future<MaybeStill>;
+
+    /// Captures `frames_count` consecutive frames at the current resolution of the stream, without decoding them, so that the capture can keep up with the camera.
+    /// Unlike capture_still(), it doesn't switch to the full resolution of the sensor, because switching would lose the frames at the beginning of the burst. Select the resolution you need before starting the burst.
+    /// All the memory is allocated before the first frame, and the frames bypass image(), which keeps returning the last image until the burst is over.
+    /// `buffers` is optional: it allows you to provide the memory in which the frames will be written (e.g. the buffers of a previous burst). The missing or too small ones are taken from the buffer pool.
+    /// Only supported on Linux for now. On other platforms, the future contains an Error_Unknown.
+    [[nodiscard]] auto capture_burst(size_t frames_count, std::vector<PooledBuffer> buffers = {}) const -> std::future<MaybeBurst>;
+
+    /// Saves the next frame of the camera to `path` as a JPEG file. Everything happens on a background thread, and `on_done` is called on that thread once the file has been written (or if it failed).
+    /// When the camera sends MJPEG, the frame is written exactly as the camera sent it. Otherwise it is encoded directly from the YUV data of the camera, without converting it to RGB. `jpeg_quality` is between 1 and 100.
+    /// Like the frames of a burst, that frame bypasses image(). Supports MJPEG, YUYV, NV12, I420, BGR24 and GRAY8 cameras.
+    /// Returns false, without calling `on_done`, if max_pending_snapshots snapshots are already waiting to be written.
+    /// Only supported on Linux for now. On other platforms, `on_done` receives an Error_Unknown.
+    [[nodiscard]] auto save_snapshot(std::filesystem::path path, SnapshotCallback on_done = {}, int jpeg_quality = 90) const -> bool;
+
 private:
     friend class internal::Manager;
-    explicit SharedWebcam(std::shared_ptr<internal::WebcamRequest> request)
+    friend class internal::VirtualCaptureImpl;
+    friend class Mosaic;
+    friend class SyncGroup;
+    SharedWebcam(std::shared_ptr<internal::WebcamRequest> request, std::shared_ptr<internal::Subscription> subscription)
         : _request{std::move(request)}
+        , _subscription{std::move(subscription)}
     {}
 
 private:
     std::shared_ptr<internal::WebcamRequest> _request;
+    std::shared_ptr<internal::Subscription>  _subscription; // Copies of a SharedWebcam share the same subscription, but each call to open_webcam() creates a new one
 };
 
 } // namespace wcam
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include "MaybeImage.hpp"
+
+namespace wcam {
+
+/// Called on the snapshot thread once SharedWebcam::save_snapshot() is done. `error` is std::nullopt iff the file has been written.
+using SnapshotCallback = std::function<void(std::optional<CaptureError> const& error)>;
+
+/// SharedWebcam::save_snapshot() refuses new snapshots while that many are already waiting to be written
+inline constexpr size_t max_pending_snapshots = 8;
+
+} // namespace wcam
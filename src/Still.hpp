@@ -0,0 +1,13 @@
+#pragma once
+#include <variant>
+#include "History.hpp"
+#include "MaybeImage.hpp"
+
+namespace wcam {
+
+/// The result of SharedWebcam::capture_still().
+/// The frame is given exactly as the camera sent it: when the camera sends MJPEG, `data` is a complete JPEG file that you can save as is, without decoding and re-encoding it.
+/// Use decode_history() if you need it as an Image.
+using MaybeStill = std::variant<HistoryFrame, CaptureError>;
+
+} // namespace wcam
@@ -0,0 +1,26 @@
+#include "SyncGroup.hpp"
+#include "internal/SyncGroupState.hpp"
+
+namespace wcam {
+
+SyncGroup::SyncGroup(std::vector<SharedWebcam> webcams, std::chrono::nanoseconds tolerance, size_t history_size)
+    : _webcams{std::move(webcams)}
+    , _state{std::make_shared<internal::SyncGroupState>(_webcams.size(), tolerance, history_size)}
+{
+    for (size_t i = 0; i < _webcams.size(); ++i)
+    {
+        auto listener = std::make_shared<internal::FrameListener>([weak_state = std::weak_ptr{_state}, i](std::shared_ptr<Image const> const& image) {
+            if (auto const state = weak_state.lock())
+                state->on_new_image(i, image);
+        });
+        _webcams[i]._subscription->add_listener(listener);
+        _state->keep_listener_alive(std::move(listener));
+    }
+}
+
+auto SyncGroup::frame_set() const -> std::optional<FrameSet>
+{
+    return _state->frame_set();
+}
+
+} // namespace wcam
@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "Image.hpp"
+#include "SharedWebcam.hpp"
+
+namespace wcam {
+
+namespace internal {
+class SyncGroupState;
+}
+
+/// Frames from several cameras that were captured at the same moment (see FrameMetadata::timestamp)
+struct FrameSet {
+    std::vector<std::shared_ptr<Image const>> images{}; /// One per camera, in the same order as the cameras given to the SyncGroup
+    std::chrono::nanoseconds                  skew{0};  /// The difference between the timestamps of the oldest and of the most recent image of the set
+    uint64_t                                  index{0}; /// Increases each time a new set is formed, so that you can know if a set is new
+};
+
+/// Pairs the frames of several cameras by timestamp, e.g. for stereo or multi-view capture.
+/// Keeps a few frames of each camera, so that a frame can be matched with the frame of another camera even if that one arrived a bit earlier.
+class SyncGroup {
+public:
+    /// `tolerance` is the maximum skew of a set. It should be less than half the frame interval of the cameras, otherwise a frame could be matched with the wrong one.
+    /// `history_size` is the number of frames we keep for each camera to find matches.
+    SyncGroup(std::vector<SharedWebcam> webcams, std::chrono::nanoseconds tolerance, size_t history_size = 4);
+
+    /// The most recent complete set, or std::nullopt if no set has been formed yet.
+    /// The set is always coherent: all of its images are replaced at once when a newer set is formed.
+    [[nodiscard]] auto frame_set() const -> std::optional<FrameSet>;
+
+    [[nodiscard]] auto webcams() const -> std::vector<SharedWebcam> const& { return _webcams; }
+
+private:
+    std::vector<SharedWebcam>                 _webcams; // Keeps the captures alive
+    std::shared_ptr<internal::SyncGroupState> _state;
+};
+
+} // namespace wcam
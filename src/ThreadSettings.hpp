@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wcam {
+
+/// The different kinds of threads that wcam runs in the background
+enum class ThreadRole {
+    Manager,  /// The thread that keeps the list of cameras up to date, and (re)starts the captures
+    Capture,  /// The threads that receive the frames from the cameras and decode them (one per capture)
+    Pipeline, /// The threads that run the stages that you added to a SharedWebcam (see SharedWebcam::add_stage())
+    Snapshot, /// The thread that encodes the snapshots and writes them to disk (see SharedWebcam::save_snapshot())
+};
+
+enum class ThreadPriority {
+    Lowest,
+    Low,
+    Normal,
+    High,
+    Highest,
+    Realtime, /// Uses SCHED_FIFO on Linux and MacOS, and THREAD_PRIORITY_TIME_CRITICAL on Windows. On Linux this requires the permission to do so (CAP_SYS_NICE, or an rtprio limit), and if it is not granted we fall back to Highest.
+};
+
+struct ThreadSettings {
+    std::string         name{};                           /// Shown in debuggers and profilers. Leave it empty to use the default name. On Linux it is truncated to 15 characters.
+    ThreadPriority      priority{ThreadPriority::Normal}; /// Normal keeps the priority that the thread inherited from your application. Where the OS doesn't allow us to change it, we silently keep that priority.
+    int                 realtime_priority{50};            /// Only used when priority is Realtime. Between 1 and 99 on Linux.
+    std::vector<size_t> cpu_affinity{};                   /// The indices of the CPU cores that the thread is allowed to run on. Empty keeps the affinity that the thread inherited from your application (e.g. from taskset). Not supported on MacOS.
+};
+
+} // namespace wcam
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+
+namespace wcam {
+
+/// A rectangle of the images of a camera, in pixels, with (0, 0) being the top-left corner of the image
+struct CropRegion {
+    uint32_t x{0};
+    uint32_t y{0};
+    uint32_t width{0};
+    uint32_t height{0};
+};
+
+} // namespace wcam
@@ -0,0 +1,138 @@
+#include "AdaptiveQualityController.hpp"
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <string>
+#include "AdaptiveQualityManager.hpp"
+
+namespace wcam::internal {
+
+static constexpr auto window_duration       = std::chrono::seconds{1};
+static constexpr auto overloaded_busy_ratio = 0.8; // Above that, frames start to pile up, so we reduce the quality
+static constexpr auto calm_busy_ratio       = 0.4; // Below that, we have enough headroom to try and restore the quality
+
+/// Percentage of the last 10 seconds during which some tasks were waiting for a CPU.
+/// std::nullopt if it is not available (not on Linux, or a kernel without Pressure Stall Information).
+static auto cpu_pressure() -> std::optional<float>
+{
+    try
+    {
+        auto file = std::ifstream{"/proc/pressure/cpu"};
+        auto word = std::string{};
+        while (file >> word) // The first line looks like "some avg10=1.23 avg60=0.87 avg300=0.42 total=123456"
+        {
+            if (word.rfind("avg10=", 0) == 0)
+                return std::stof(word.substr(6));
+        }
+    }
+    catch (std::exception const&)
+    {
+    }
+    return std::nullopt;
+}
+
+AdaptiveQualityController::AdaptiveQualityController(DeviceId id, bool supports_scaled_decode)
+    : _id{std::move(id)}
+    , _supports_scaled_decode{supports_scaled_decode}
+{
+    rebuild_levels();
+    // If we were restarted because we lowered the resolution, start at the level that uses that resolution
+    auto const resolution_steps_down = adaptive_quality_manager().resolution_steps_down(_id);
+    auto const it                    = std::find_if(_levels.begin(), _levels.end(), [&](Level const& level) {
+        return level.resolution_steps_down == resolution_steps_down;
+    });
+    if (it != _levels.end())
+        _level_index = static_cast<size_t>(it - _levels.begin());
+}
+
+void AdaptiveQualityController::rebuild_levels()
+{
+    _settings = adaptive_quality_manager().settings(_id);
+    _levels   = {Level{}};
+    if (!_settings.enabled)
+    {
+        _level_index = 0;
+        return;
+    }
+
+    auto level = Level{};
+    while (level.frames_to_skip < _settings.max_frames_skipped)
+    {
+        level.frames_to_skip++;
+        _levels.push_back(level);
+    }
+    while (_supports_scaled_decode && level.jpeg_scale_denominator * 2 <= std::min(_settings.max_jpeg_scale_denominator, 8u)) // libjpeg only supports scaling down by 2, 4 and 8
+    {
+        level.jpeg_scale_denominator *= 2;
+        _levels.push_back(level);
+    }
+    auto const max_resolution_steps_down = adaptive_quality_manager().max_resolution_steps_down(_id);
+    while (level.resolution_steps_down < max_resolution_steps_down)
+    {
+        level.resolution_steps_down++;
+        _levels.push_back(level);
+    }
+    _level_index = std::min(_level_index, _levels.size() - 1);
+}
+
+auto AdaptiveQualityController::should_process_frame() -> bool
+{
+    return _frames_count++ % (current_level().frames_to_skip + 1) == 0;
+}
+
+void AdaptiveQualityController::on_frame_processed(std::chrono::steady_clock::duration processing_time)
+{
+    _busy_time += processing_time;
+    auto const now     = std::chrono::steady_clock::now();
+    auto const elapsed = now - _window_start;
+    if (elapsed < window_duration)
+        return;
+
+    on_window_finished(std::chrono::duration<double>{_busy_time} / std::chrono::duration<double>{elapsed});
+    _window_start = now;
+    _busy_time    = {};
+}
+
+void AdaptiveQualityController::on_window_finished(double busy_ratio)
+{
+    rebuild_levels(); // The settings might have changed
+    if (!_settings.enabled || _wants_to_change_resolution)
+        return;
+
+    auto const pressure     = _settings.max_cpu_pressure ? cpu_pressure() : std::nullopt;
+    bool const is_pressured = pressure && *pressure > *_settings.max_cpu_pressure;
+
+    if (busy_ratio > overloaded_busy_ratio || is_pressured)
+    {
+        _calm_windows_count = 0;
+        if (_level_index + 1 < _levels.size())
+            change_level(_level_index + 1);
+        return;
+    }
+    if (busy_ratio > calm_busy_ratio || _level_index == 0)
+    {
+        _calm_windows_count = 0;
+        return;
+    }
+
+    _calm_windows_count++;
+    bool const restoring_changes_resolution = _levels[_level_index - 1].resolution_steps_down != current_level().resolution_steps_down;
+    if (_calm_windows_count >= (restoring_changes_resolution ? 10u : 3u)) // Restarting the capture is expensive and visible, so we want to be more certain that we have headroom before doing it
+    {
+        _calm_windows_count = 0;
+        change_level(_level_index - 1);
+    }
+}
+
+void AdaptiveQualityController::change_level(size_t new_level_index)
+{
+    auto const old_resolution_steps_down = current_level().resolution_steps_down;
+    _level_index                         = new_level_index;
+    if (current_level().resolution_steps_down != old_resolution_steps_down)
+    {
+        adaptive_quality_manager().set_resolution_steps_down(_id, current_level().resolution_steps_down);
+        _wants_to_change_resolution = true;
+    }
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "../AdaptiveQualitySettings.hpp"
+#include "../DeviceId.hpp"
+
+namespace wcam::internal {
+
+/// Watches how busy a capture thread is, and progressively makes the capture cheaper when it can't keep up with the camera (or when the CPU is under pressure).
+/// Restores the quality once there is headroom again. See AdaptiveQualitySettings for more details.
+class AdaptiveQualityController {
+public:
+    /// `supports_scaled_decode` must be true iff the capture can decode its frames at a lower resolution (i.e. when it receives MJPEG frames)
+    AdaptiveQualityController(DeviceId id, bool supports_scaled_decode);
+
+    /// Must be called for each frame received from the camera. Returns false iff that frame should be dropped without being processed.
+    [[nodiscard]] auto should_process_frame() -> bool;
+    /// Must be called after each processed frame, with the time it took to decode it and give it to the Image.
+    void on_frame_processed(std::chrono::steady_clock::duration processing_time);
+
+    [[nodiscard]] auto jpeg_scale_denominator() const -> uint32_t { return current_level().jpeg_scale_denominator; }
+    /// When true, the capture needs to be restarted so that it uses a different resolution
+    [[nodiscard]] auto wants_to_change_resolution() const -> bool { return _wants_to_change_resolution; }
+
+private:
+    struct Level {
+        uint32_t frames_to_skip{0};
+        uint32_t jpeg_scale_denominator{1};
+        uint32_t resolution_steps_down{0};
+    };
+
+    [[nodiscard]] auto current_level() const -> Level const& { return _levels[_level_index]; }
+    void               rebuild_levels();
+    void               change_level(size_t new_level_index);
+    void               on_window_finished(double busy_ratio);
+
+private:
+    DeviceId                _id;
+    bool                    _supports_scaled_decode;
+    AdaptiveQualitySettings _settings{};
+    std::vector<Level>      _levels{};
+    size_t                  _level_index{0};
+    bool                    _wants_to_change_resolution{false};
+
+    uint64_t                              _frames_count{0};
+    std::chrono::steady_clock::time_point _window_start{std::chrono::steady_clock::now()};
+    std::chrono::steady_clock::duration   _busy_time{};
+    uint32_t                              _calm_windows_count{0};
+};
+
+} // namespace wcam::internal
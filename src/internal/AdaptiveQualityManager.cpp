@@ -0,0 +1,84 @@
+#include "AdaptiveQualityManager.hpp"
+#include "Manager.hpp"
+
+namespace wcam::internal {
+
+auto AdaptiveQualityManager::settings(DeviceId const& id) const -> AdaptiveQualitySettings
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _states.find(id);
+    if (it == _states.end())
+        return {};
+    return it->second.settings;
+}
+
+void AdaptiveQualityManager::set_settings(DeviceId const& id, AdaptiveQualitySettings settings)
+{
+    bool needs_restart = false;
+    {
+        std::scoped_lock lock{_mutex};
+        auto&            state = _states[id];
+        state.settings         = settings;
+        if (!settings.enabled && state.resolution_steps_down != 0)
+        {
+            state.resolution_steps_down = 0; // Go back to the selected resolution
+            needs_restart               = true;
+        }
+    }
+
+    auto const manager = manager_unchecked();
+    if (needs_restart && manager)
+        manager->request_a_restart_of_the_capture_if_it_exists(id);
+}
+
+static auto has_same_aspect_ratio(Resolution a, Resolution b) -> bool
+{
+    return static_cast<uint64_t>(a.width()) * b.height() == static_cast<uint64_t>(b.width()) * a.height();
+}
+
+auto AdaptiveQualityManager::capture_resolution(DeviceId const& id, Resolution selected_resolution, std::vector<Resolution> const& resolutions) -> Resolution
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _states.find(id);
+    if (it == _states.end() || !it->second.settings.enabled || !it->second.settings.min_resolution)
+        return selected_resolution;
+    auto& state = it->second;
+
+    auto lower_resolutions = std::vector<Resolution>{};
+    for (auto const& resolution : resolutions)
+    {
+        if (resolution.pixels_count() < selected_resolution.pixels_count()
+            && resolution.pixels_count() >= state.settings.min_resolution->pixels_count()
+            && has_same_aspect_ratio(resolution, selected_resolution))
+        {
+            lower_resolutions.push_back(resolution);
+        }
+    }
+    state.max_resolution_steps_down = static_cast<uint32_t>(lower_resolutions.size());
+    state.resolution_steps_down     = std::min(state.resolution_steps_down, state.max_resolution_steps_down);
+    if (state.resolution_steps_down == 0)
+        return selected_resolution;
+    return lower_resolutions[state.resolution_steps_down - 1];
+}
+
+auto AdaptiveQualityManager::resolution_steps_down(DeviceId const& id) const -> uint32_t
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _states.find(id);
+    return it == _states.end() ? 0 : it->second.resolution_steps_down;
+}
+
+auto AdaptiveQualityManager::max_resolution_steps_down(DeviceId const& id) const -> uint32_t
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _states.find(id);
+    return it == _states.end() ? 0 : it->second.max_resolution_steps_down;
+}
+
+void AdaptiveQualityManager::set_resolution_steps_down(DeviceId const& id, uint32_t steps)
+{
+    std::scoped_lock lock{_mutex};
+    _states[id].resolution_steps_down = steps;
+}
+
+} // namespace wcam::internal
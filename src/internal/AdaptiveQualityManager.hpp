@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../AdaptiveQualitySettings.hpp"
+#include "../DeviceId.hpp"
+
+namespace wcam::internal {
+
+class AdaptiveQualityManager {
+public:
+    [[nodiscard]] auto settings(DeviceId const&) const -> AdaptiveQualitySettings;
+    void               set_settings(DeviceId const&, AdaptiveQualitySettings);
+
+    /// The resolution that we should actually capture at, once the resolution steps that the adaptive quality took are taken into account.
+    /// `resolutions` must be sorted from largest to smallest.
+    [[nodiscard]] auto capture_resolution(DeviceId const&, Resolution selected_resolution, std::vector<Resolution> const& resolutions) -> Resolution;
+
+    [[nodiscard]] auto resolution_steps_down(DeviceId const&) const -> uint32_t;
+    [[nodiscard]] auto max_resolution_steps_down(DeviceId const&) const -> uint32_t;
+    void               set_resolution_steps_down(DeviceId const&, uint32_t steps);
+
+private:
+    struct DeviceState {
+        AdaptiveQualitySettings settings{};
+        uint32_t                resolution_steps_down{0};
+        uint32_t                max_resolution_steps_down{0}; // Updated each time we compute the capture_resolution()
+    };
+
+    std::unordered_map<DeviceId, DeviceState> _states{};
+    mutable std::mutex                        _mutex{};
+};
+
+inline auto adaptive_quality_manager() -> AdaptiveQualityManager& // Not part of the Manager, for the same reasons as the ResolutionsManager: we want to remember the settings even when the library is not alive
+{
+    static auto instance = AdaptiveQualityManager{};
+    return instance;
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,48 @@
+#include "BackendCaptureImpl.hpp"
+#include "BackendsRegistry.hpp"
+#include "BufferPool.hpp"
+
+namespace wcam::internal {
+
+BackendCaptureImpl::BackendCaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions)
+    : ICaptureImpl{id, std::move(subscriptions)}
+{
+    auto webcam = backends_registry().find(id);
+    if (!webcam)
+        throw CaptureException{Error_WebcamUnplugged{}}; // Its backend has been unregistered in the meantime
+
+    _backend           = std::move(webcam->backend);
+    auto maybe_capture = _backend->open(webcam->id, resolution, *this);
+    if (auto* const error = std::get_if<CaptureError>(&maybe_capture))
+        throw CaptureException{std::move(*error)};
+    _capture = std::move(std::get<std::unique_ptr<BackendCapture>>(maybe_capture));
+    if (!_capture)
+        throw CaptureException{Error_Unknown{"The backend didn't give us a capture"}};
+}
+
+BackendCaptureImpl::~BackendCaptureImpl()
+{
+    _capture.reset(); // Stops the capture before the rest of this object gets destroyed, because the backend might still be using us as its FrameSink on its own thread
+}
+
+auto BackendCaptureImpl::acquire_buffer(size_t size) -> PooledBuffer
+{
+    auto const scoped_account = count_allocations();
+    return buffer_pool().acquire(size);
+}
+
+void BackendCaptureImpl::publish_image(std::shared_ptr<Image> image, FrameMetadata metadata)
+{
+    if (!image)
+        return;
+    set_frame_metadata(*image, std::move(metadata));
+    set_image(std::move(image));
+}
+
+void BackendCaptureImpl::publish_error(CaptureError error)
+{
+    set_image(std::move(error));
+    request_restart();
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,30 @@
+#pragma once
+#include <memory>
+#include "../Backend.hpp"
+#include "ICaptureImpl.hpp"
+
+namespace wcam::internal {
+
+/// The capture of a camera that comes from a Backend (see register_backend()).
+/// The backend captures the frames on its own threads, and gives them to us through the FrameSink interface.
+class BackendCaptureImpl : public ICaptureImpl, public FrameSink {
+public:
+    BackendCaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions);
+    ~BackendCaptureImpl() override;
+    BackendCaptureImpl(BackendCaptureImpl const&)                        = delete;
+    auto operator=(BackendCaptureImpl const&) -> BackendCaptureImpl&     = delete;
+    BackendCaptureImpl(BackendCaptureImpl&&) noexcept                    = delete;
+    auto operator=(BackendCaptureImpl&&) noexcept -> BackendCaptureImpl& = delete;
+
+    [[nodiscard]] auto is_frame_wanted() -> bool override { return ICaptureImpl::is_frame_wanted(); }
+    [[nodiscard]] auto acquire_buffer(size_t size) -> PooledBuffer override;
+    [[nodiscard]] auto make_image() -> std::shared_ptr<Image> override { return ICaptureImpl::make_image(); }
+    void               publish_image(std::shared_ptr<Image> image, FrameMetadata) override;
+    void               publish_error(CaptureError) override;
+
+private:
+    std::shared_ptr<Backend>        _backend{}; // Keeps the backend alive as long as its capture, even if it gets unregistered in the meantime
+    std::unique_ptr<BackendCapture> _capture{};
+};
+
+} // namespace wcam::internal
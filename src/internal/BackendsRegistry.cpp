@@ -0,0 +1,71 @@
+#include "BackendsRegistry.hpp"
+#include <cassert>
+#include <string_view>
+#include "make_device_id.hpp"
+
+namespace wcam::internal {
+
+/// The ids of the cameras of a backend start with that prefix, so that they can never collide with the ones of the native cameras nor with the ones of another backend
+static auto id_prefix(std::string const& backend_name) -> std::string
+{
+    return "backend:" + backend_name + ":";
+}
+
+void BackendsRegistry::add(std::string name, std::shared_ptr<Backend> backend)
+{
+    if (name.find(':') != std::string::npos)
+    {
+        assert(false && "The name of a backend must not contain ':', because we use it to separate the name from the id of the camera in the DeviceId");
+        return;
+    }
+    std::scoped_lock lock{_mutex};
+    _backends[std::move(name)] = std::move(backend);
+}
+
+void BackendsRegistry::remove(std::string const& name)
+{
+    std::scoped_lock lock{_mutex};
+    _backends.erase(name);
+}
+
+auto BackendsRegistry::infos() const -> std::vector<Info>
+{
+    auto const backends = [&]() { // IIFE
+        std::scoped_lock lock{_mutex};
+        return _backends;
+    }();
+
+    auto infos = std::vector<Info>{};
+    for (auto const& [name, backend] : backends) // Outside of the lock, because the backends might be slow to list their cameras
+    {
+        for (auto& webcam_info : backend->webcams_infos())
+        {
+            infos.push_back({
+                .name        = std::move(webcam_info.name),
+                .id          = make_device_id(id_prefix(name) + webcam_info.id),
+                .resolutions = std::move(webcam_info.resolutions),
+            });
+        }
+    }
+    return infos;
+}
+
+auto BackendsRegistry::find(DeviceId const& id) const -> std::optional<BackendWebcam>
+{
+    // The id looks like "backend:<name>:<id of the camera inside its backend>", and the names can't contain ':'
+    auto const prefix = std::string_view{"backend:"};
+    auto const string = std::string_view{id.as_string()};
+    if (!string.starts_with(prefix))
+        return std::nullopt;
+    auto const name_end = string.find(':', prefix.size());
+    if (name_end == std::string_view::npos)
+        return std::nullopt;
+
+    std::scoped_lock lock{_mutex};
+    auto const       it = _backends.find(std::string{string.substr(prefix.size(), name_end - prefix.size())});
+    if (it == _backends.end())
+        return std::nullopt;
+    return BackendWebcam{it->second, std::string{string.substr(name_end + 1)}};
+}
+
+} // namespace wcam::internal
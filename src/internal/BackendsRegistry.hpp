@@ -0,0 +1,40 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Backend.hpp"
+#include "../DeviceId.hpp"
+#include "../Info.hpp"
+
+namespace wcam::internal {
+
+struct BackendWebcam {
+    std::shared_ptr<Backend> backend{};
+    std::string              id{}; // The id of the camera inside its backend
+};
+
+/// The backends added by register_backend()
+class BackendsRegistry {
+public:
+    void               add(std::string name, std::shared_ptr<Backend>);
+    void               remove(std::string const& name);
+    /// The cameras of all the backends. Must only be called from the Manager thread.
+    [[nodiscard]] auto infos() const -> std::vector<Info>;
+    /// std::nullopt if the camera doesn't belong to one of the backends
+    [[nodiscard]] auto find(DeviceId const&) const -> std::optional<BackendWebcam>;
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<Backend>> _backends{};
+    mutable std::mutex                                        _mutex{};
+};
+
+inline auto backends_registry() -> BackendsRegistry&
+{
+    static auto instance = BackendsRegistry{};
+    return instance;
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,76 @@
+#include "BufferPool.hpp"
+
+namespace wcam::internal {
+
+static constexpr size_t max_cached_buffers_per_size = 8; // Enough for a few frames in flight, without hoarding memory when the resolution changes
+
+/// The memory that is cached counts towards the global budget, so we release it before going over the budget
+static auto cache_fits_in_global_budget(MemoryBudgetManager& budgets, size_t cached_bytes) -> bool
+{
+    auto const max_bytes = budgets.global_budget().max_bytes;
+    return !max_bytes || budgets.global_account().bytes_in_use() + cached_bytes <= *max_bytes;
+}
+
+auto BufferPool::acquire(size_t size) -> PooledBuffer
+{
+    auto memory = std::unique_ptr<uint8_t[]>{}; // NOLINT(*c-arrays)
+    {
+        std::scoped_lock lock{_storage->mutex};
+        auto const       it = _storage->free_buffers.find(size);
+        if (it != _storage->free_buffers.end() && !it->second.empty())
+        {
+            memory = std::move(it->second.back());
+            it->second.pop_back();
+            _storage->cached_bytes -= size;
+        }
+    }
+    if (!memory)
+    {
+        if (!cache_fits_in_global_budget(*_storage->budgets, cached_bytes() + size))
+            release_cached_memory();
+        memory = std::unique_ptr<uint8_t[]>(new uint8_t[size]); // NOLINT(*c-arrays, *owning-memory) Not std::make_unique_for_overwrite(), which is missing from the libc++ of older macOS versions
+    }
+
+    auto account = ScopedMemoryAccount::current();
+    _storage->budgets->global_account().on_allocate(size);
+    if (account)
+        account->on_allocate(size);
+    return PooledBuffer{
+        std::shared_ptr<uint8_t>{memory.release(), [storage = _storage, size, account = std::move(account)](uint8_t* ptr) {
+                                     storage->budgets->global_account().on_free(size);
+                                     if (account)
+                                         account->on_free(size);
+                                     storage->give_back(std::unique_ptr<uint8_t[]>{ptr}, size); // NOLINT(*c-arrays)
+                                     storage->budgets->on_memory_freed();
+                                 }},
+        size,
+    };
+}
+
+auto BufferPool::cached_bytes() const -> size_t
+{
+    std::scoped_lock lock{_storage->mutex};
+    return _storage->cached_bytes;
+}
+
+void BufferPool::release_cached_memory()
+{
+    std::scoped_lock lock{_storage->mutex};
+    _storage->free_buffers.clear();
+    _storage->cached_bytes = 0;
+}
+
+void BufferPool::Storage::give_back(std::unique_ptr<uint8_t[]> memory, size_t size) // NOLINT(*c-arrays)
+{
+    std::scoped_lock lock{mutex};
+    auto&            buffers = free_buffers[size];
+    if (buffers.size() >= max_cached_buffers_per_size
+        || !cache_fits_in_global_budget(*budgets, cached_bytes + size))
+    {
+        return; // memory will be freed
+    }
+    buffers.push_back(std::move(memory));
+    cached_bytes += size;
+}
+
+} // namespace wcam::internal
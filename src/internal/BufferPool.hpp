@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../PooledBuffer.hpp"
+#include "MemoryBudgetManager.hpp"
+
+namespace wcam::internal {
+
+/// Recycles the memory of the frames, so that we don't have to allocate (and page-fault) several megabytes for each new frame.
+/// Buffers are grouped by size, which works well because all the frames of a given capture have the same size.
+/// All the buffers are counted in the global MemoryAccount, and in the one of the current thread's ScopedMemoryAccount if there is one.
+class BufferPool {
+public:
+    [[nodiscard]] auto acquire(size_t size) -> PooledBuffer;
+
+    /// The memory that is kept around, ready to be reused
+    [[nodiscard]] auto cached_bytes() const -> size_t;
+    void               release_cached_memory();
+
+private:
+    struct Storage {
+        std::unordered_map<size_t, std::vector<std::unique_ptr<uint8_t[]>>> free_buffers{}; // NOLINT(*c-arrays)
+        size_t                                                             cached_bytes{0};
+        std::mutex                                                         mutex{};
+        std::shared_ptr<MemoryBudgetManager>                               budgets{shared_memory_budgets()}; // Kept alive as long as some buffers might use it, see shared_memory_budgets()
+
+        void give_back(std::unique_ptr<uint8_t[]>, size_t size); // NOLINT(*c-arrays)
+    };
+    std::shared_ptr<Storage> _storage{std::make_shared<Storage>()}; // Shared with the buffers, because they might be destroyed after the pool (e.g. if the user holds onto an image until the end of the application)
+};
+
+inline auto buffer_pool() -> BufferPool&
+{
+    static auto instance = BufferPool{};
+    return instance;
+}
+
+} // namespace wcam::internal
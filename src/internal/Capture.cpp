@@ -1,12 +1,25 @@
 #include "Capture.hpp"
+#include "BackendCaptureImpl.hpp"
+#include "BackendsRegistry.hpp"
+#include "VirtualCaptureImpl.hpp"
+#include "VirtualWebcamsManager.hpp"
 #include "wcam_linux.hpp"
 #include "wcam_macos.hpp"
 #include "wcam_windows.hpp"
 
 namespace wcam::internal {
 
-Capture::Capture(DeviceId const& id, Resolution const& resolution)
-    : _pimpl{std::make_unique<internal::CaptureImpl>(id, resolution)}
+static auto make_capture_impl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions) -> std::unique_ptr<ICaptureImpl>
+{
+    if (virtual_webcams_manager().find(id))
+        return std::make_unique<VirtualCaptureImpl>(id, std::move(subscriptions)); // Its resolution is the one of its region
+    if (backends_registry().find(id))
+        return std::make_unique<BackendCaptureImpl>(id, resolution, std::move(subscriptions));
+    return std::make_unique<internal::CaptureImpl>(id, resolution, std::move(subscriptions));
+}
+
+Capture::Capture(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions)
+    : _pimpl{make_capture_impl(id, resolution, std::move(subscriptions))}
 {
 }
 
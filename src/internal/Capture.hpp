@@ -8,9 +8,14 @@ namespace wcam::internal {
 
 class Capture {
 public:
-    Capture(DeviceId const& id, Resolution const& resolution);
+    Capture(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions);
 
     [[nodiscard]] auto image() -> MaybeImage { return _pimpl->image(); }
+    [[nodiscard]] auto needs_restart() const -> bool { return _pimpl->needs_restart(); }
+    void               request_restart() { _pimpl->request_restart(); }
+    [[nodiscard]] auto reconfigure(Resolution const& resolution) -> bool { return _pimpl->reconfigure(resolution); }
+    [[nodiscard]] auto capture_still(Resolution const& resolution) -> MaybeStill { return _pimpl->capture_still(resolution); }
+    void               start_burst(BurstRequest request) { _pimpl->start_burst(std::move(request)); }
 
 private:
     std::unique_ptr<internal::ICaptureImpl> _pimpl;
@@ -0,0 +1,158 @@
+#include "CroppingImage.hpp"
+#include <cstring>
+#include <optional>
+#include "BufferPool.hpp"
+
+namespace wcam::internal {
+
+CroppingImage::CroppingImage(std::shared_ptr<Image> image, std::vector<std::shared_ptr<CropSubscriber>> const& subscribers)
+    : _image{std::move(image)}
+{
+    _crops.reserve(subscribers.size());
+    for (auto const& subscriber : subscribers)
+        _crops.push_back({subscriber, subscriber->make_image()});
+}
+
+static auto covers_whole_frame(CropRegion region, Resolution resolution) -> bool
+{
+    return region.x == 0 && region.y == 0 && region.width >= resolution.width() && region.height >= resolution.height();
+}
+
+/// The region might not fit in the frame, e.g. when the physical camera uses a smaller resolution than the one the region was designed for
+static auto clamp_region(CropRegion region, Resolution resolution) -> std::optional<CropRegion>
+{
+    auto const x      = std::min(region.x, resolution.width()) & ~1u;
+    auto const y      = std::min(region.y, resolution.height()) & ~1u;
+    auto const width  = std::min(region.width, resolution.width() - x) & ~1u;
+    auto const height = std::min(region.height, resolution.height() - y) & ~1u;
+    if (width == 0 || height == 0)
+        return std::nullopt;
+    return CropRegion{.x = x, .y = y, .width = width, .height = height};
+}
+
+/// The index, in memory, of the first row of the region
+static auto first_row_in_memory(CropRegion region, Resolution resolution, FirstRowIs row_order) -> uint32_t
+{
+    return row_order == FirstRowIs::Top ? region.y : resolution.height() - region.y - region.height;
+}
+
+/// For the formats that store all the bytes of a pixel next to each other
+template<typename PixelFormatT>
+static void set_cropped_data(Image& image, ImageDataView<PixelFormatT> const& view, CropRegion region)
+{
+    auto const resolution      = Resolution{region.width, region.height};
+    auto const bytes_per_pixel = PixelFormatT::data_length(Resolution{2, 1}) / 2; // Two pixels, because YUYV shares its colors between pairs of pixels
+    auto const row_size        = region.width * bytes_per_pixel;
+    auto const bytes_per_row   = view.resolution().width() * bytes_per_pixel;
+    auto const first_row       = first_row_in_memory(region, view.resolution(), view.row_order());
+
+    auto buffer = buffer_pool().acquire(PixelFormatT::data_length(resolution));
+    for (uint32_t row = 0; row < region.height; ++row)
+        std::memcpy(buffer.data() + row * row_size, view.data() + (first_row + row) * bytes_per_row + region.x * bytes_per_pixel, row_size); // NOLINT(*pointer-arithmetic)
+    image.set_data(ImageDataView<PixelFormatT>{buffer.shared_data(), buffer.size(), resolution, view.row_order()});
+}
+
+/// Zero-copy: the planes of the crop point inside the planes of the frame
+static void set_cropped_data(Image& image, ImagePlanesView<NV12> const& view, CropRegion region)
+{
+    auto const  first_row = first_row_in_memory(region, view.resolution(), view.row_order());
+    auto const& luma      = view.plane(0);
+    auto const& chroma    = view.plane(1);
+    image.set_data(ImagePlanesView<NV12>{
+        {
+            ImagePlane{luma.data + first_row * luma.bytes_per_row + region.x, luma.bytes_per_row},             // NOLINT(*pointer-arithmetic)
+            ImagePlane{chroma.data + first_row / 2 * chroma.bytes_per_row + region.x, chroma.bytes_per_row}, // NOLINT(*pointer-arithmetic) U and V are interleaved, so they use as many bytes per row as the luma
+        },
+        Resolution{region.width, region.height},
+        view.row_order(),
+    });
+}
+
+/// Zero-copy: the planes of the crop point inside the planes of the frame
+static void set_cropped_data(Image& image, ImagePlanesView<I420> const& view, CropRegion region)
+{
+    auto const first_row  = first_row_in_memory(region, view.resolution(), view.row_order());
+    auto const crop_plane = [&](size_t index, uint32_t subsampling) {
+        auto const& plane = view.plane(index);
+        return ImagePlane{plane.data + first_row / subsampling * plane.bytes_per_row + region.x / subsampling, plane.bytes_per_row}; // NOLINT(*pointer-arithmetic)
+    };
+    image.set_data(ImagePlanesView<I420>{{crop_plane(0, 1), crop_plane(1, 2), crop_plane(2, 2)}, Resolution{region.width, region.height}, view.row_order()});
+}
+
+static void set_cropped_data(Image& image, ImageDataView<NV12> const& view, CropRegion region)
+{
+    auto const width = static_cast<size_t>(view.resolution().width());
+    set_cropped_data(image, ImagePlanesView<NV12>{{ImagePlane{view.data(), width}, ImagePlane{view.data() + view.resolution().pixels_count(), width}}, view.resolution(), view.row_order()}, region); // NOLINT(*pointer-arithmetic)
+}
+
+template<typename ViewT>
+void CroppingImage::forward(ViewT const& view)
+{
+    _image->set_data(view);
+    for (auto& crop : _crops)
+    {
+        if (covers_whole_frame(crop.subscriber->region(), view.resolution()))
+        {
+            crop.image->set_data(view); // No need to copy anything
+            crop.has_data = true;
+            continue;
+        }
+        auto const region = clamp_region(crop.subscriber->region(), view.resolution());
+        if (!region)
+            continue;
+        set_cropped_data(*crop.image, view, *region);
+        crop.has_data = true;
+    }
+}
+
+void CroppingImage::set_data(ImageDataView<RGB24> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImageDataView<BGR24> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImageDataView<NV12> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImageDataView<YUYV> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImageDataView<RGBA32> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImageDataView<GRAY8> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImageDataView<GRAY16> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImagePlanesView<NV12> const& view)
+{
+    forward(view);
+}
+void CroppingImage::set_data(ImagePlanesView<I420> const& view)
+{
+    forward(view);
+}
+
+auto CroppingImage::publish_crops() const -> std::shared_ptr<Image const>
+{
+    set_frame_metadata(*_image, metadata());
+    for (auto const& crop : _crops)
+    {
+        if (!crop.has_data)
+            continue;
+        set_frame_metadata(*crop.image, metadata());
+        crop.subscriber->on_new_image(crop.image);
+    }
+    return _image;
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,43 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "../Image.hpp"
+#include "Subscriptions.hpp"
+
+namespace wcam::internal {
+
+/// The image that a capture fills when some virtual cameras show a region of its images (see add_virtual_webcam()).
+/// Forwards the whole frame to the image of the camera, and only the cropped regions to the images of the virtual cameras, so that each of them only converts its own region.
+class CroppingImage : public Image {
+public:
+    CroppingImage(std::shared_ptr<Image> image, std::vector<std::shared_ptr<CropSubscriber>> const& subscribers);
+
+    void set_data(ImageDataView<RGB24> const&) override;
+    void set_data(ImageDataView<BGR24> const&) override;
+    void set_data(ImageDataView<NV12> const&) override;
+    void set_data(ImageDataView<YUYV> const&) override;
+    void set_data(ImageDataView<RGBA32> const&) override;
+    void set_data(ImageDataView<GRAY8> const&) override;
+    void set_data(ImageDataView<GRAY16> const&) override;
+    void set_data(ImagePlanesView<NV12> const&) override;
+    void set_data(ImagePlanesView<I420> const&) override;
+
+    /// Gives their images to the virtual cameras, and returns the image of the camera. They all get the metadata that was set on this image.
+    [[nodiscard]] auto publish_crops() const -> std::shared_ptr<Image const>;
+
+private:
+    template<typename ViewT>
+    void forward(ViewT const&);
+
+private:
+    struct Crop {
+        std::shared_ptr<CropSubscriber> subscriber;
+        std::shared_ptr<Image>          image;
+        bool                            has_data{false}; // False when the region is outside of the frame
+    };
+
+    std::shared_ptr<Image> _image;
+    std::vector<Crop>      _crops{};
+};
+
+} // namespace wcam::internal
@@ -0,0 +1,62 @@
+#include "DeviceClock.hpp"
+
+namespace wcam::internal {
+
+static constexpr size_t min_samples_count = 8;
+static constexpr size_t max_samples_count = 64; // About 2 seconds at 30 fps. Long enough to average out the jitter of the USB transfers, short enough to follow the drift of the clocks.
+
+auto DeviceClock::unwrap(uint32_t device_time) const -> int64_t
+{
+    if (_samples.empty())
+        return device_time;
+    auto const last = _samples.back().device_time;
+    return last + static_cast<int32_t>(device_time - static_cast<uint32_t>(last)); // The difference is small compared to the range of the clock, so it is correct even when the clock wrapped around in between
+}
+
+void DeviceClock::add_sample(uint32_t device_time, std::chrono::steady_clock::time_point host_time)
+{
+    auto const unwrapped_time = unwrap(device_time);
+    if (!_samples.empty() && unwrapped_time <= _samples.back().device_time)
+        return; // The clock went back in time, or the sample is a duplicate
+    _samples.push_back({unwrapped_time, host_time});
+    if (_samples.size() > max_samples_count)
+        _samples.pop_front();
+}
+
+auto DeviceClock::to_host_time(uint32_t device_time) const -> std::optional<std::chrono::steady_clock::time_point>
+{
+    if (_samples.size() < min_samples_count)
+        return std::nullopt;
+
+    // Everything is relative to the first sample, to keep good precision with doubles
+    auto const& origin = _samples.front();
+    auto const  x      = [&](Sample const& sample) { return static_cast<double>(sample.device_time - origin.device_time); };
+    auto const  y      = [&](Sample const& sample) { return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(sample.host_time - origin.host_time).count()); };
+
+    double mean_x = 0.;
+    double mean_y = 0.;
+    for (auto const& sample : _samples)
+    {
+        mean_x += x(sample);
+        mean_y += y(sample);
+    }
+    mean_x /= static_cast<double>(_samples.size());
+    mean_y /= static_cast<double>(_samples.size());
+
+    double covariance = 0.;
+    double variance   = 0.;
+    for (auto const& sample : _samples)
+    {
+        covariance += (x(sample) - mean_x) * (y(sample) - mean_y);
+        variance += (x(sample) - mean_x) * (x(sample) - mean_x);
+    }
+    if (variance == 0.)
+        return std::nullopt;
+
+    auto const nanoseconds_per_tick = covariance / variance;
+    auto const device_x             = static_cast<double>(unwrap(device_time) - origin.device_time);
+    auto const host_y               = mean_y + nanoseconds_per_tick * (device_x - mean_x);
+    return origin.host_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds{static_cast<int64_t>(host_y)});
+}
+
+} // namespace wcam::internal
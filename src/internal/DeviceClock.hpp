@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace wcam::internal {
+
+/// Converts the timestamps given by the clock of a camera to our own clock.
+/// UVC cameras have a 32-bit clock that wraps around, and whose frequency is only written in their USB descriptors.
+/// So we estimate both the rate and the offset of the clock with a linear regression on the recent pairs of (camera time, host time) that we observe.
+class DeviceClock {
+public:
+    void               add_sample(uint32_t device_time, std::chrono::steady_clock::time_point host_time);
+    /// std::nullopt until we have enough samples to have a reliable estimation
+    [[nodiscard]] auto to_host_time(uint32_t device_time) const -> std::optional<std::chrono::steady_clock::time_point>;
+
+private:
+    /// Turns the 32-bit time into a 64-bit one that doesn't wrap around, assuming that it is close to the last sample
+    [[nodiscard]] auto unwrap(uint32_t device_time) const -> int64_t;
+
+private:
+    struct Sample {
+        int64_t                               device_time;
+        std::chrono::steady_clock::time_point host_time;
+    };
+    std::deque<Sample> _samples{};
+};
+
+} // namespace wcam::internal
@@ -0,0 +1,39 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include "../DeviceId.hpp"
+
+namespace wcam::internal {
+
+/// Remembers a setting for each device. Devices for which nothing has been set use the default value of SettingsT.
+template<typename SettingsT>
+class DeviceSettingsManager {
+public:
+    [[nodiscard]] auto settings(DeviceId const& id) const -> SettingsT
+    {
+        std::scoped_lock lock{_mutex};
+        auto const       it = _settings.find(id);
+        if (it == _settings.end())
+            return SettingsT{};
+        return it->second;
+    }
+
+    void set_settings(DeviceId const& id, SettingsT settings)
+    {
+        std::scoped_lock lock{_mutex};
+        _settings[id] = std::move(settings);
+    }
+
+private:
+    std::unordered_map<DeviceId, SettingsT> _settings{};
+    mutable std::mutex                      _mutex{};
+};
+
+template<typename SettingsT>
+auto device_settings() -> DeviceSettingsManager<SettingsT>& // Not part of the Manager, for the same reasons as the ResolutionsManager: we want to remember the settings even when the library is not alive
+{
+    static auto instance = DeviceSettingsManager<SettingsT>{};
+    return instance;
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,132 @@
+#include "FramePacer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace wcam::internal {
+
+/// The average over roughly the last 16 values
+static auto smoothed(double average, double value) -> double
+{
+    return average + (value - average) / 16.;
+}
+
+static auto nanoseconds(std::chrono::steady_clock::duration duration) -> double
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+static auto microseconds(double nanoseconds) -> std::chrono::microseconds
+{
+    return std::chrono::microseconds{static_cast<std::chrono::microseconds::rep>(nanoseconds / 1000.)};
+}
+
+auto FramePacer::settings() const -> PacingSettings
+{
+    std::scoped_lock lock{_mutex};
+    return _settings;
+}
+
+void FramePacer::set_settings(PacingSettings settings)
+{
+    std::scoped_lock lock{_mutex};
+    _settings = settings;
+    if (!_settings.enabled)
+    {
+        _pending_frames.clear();
+        _current_frame.reset();
+    }
+}
+
+auto FramePacer::stats() const -> PacingStats
+{
+    std::scoped_lock lock{_mutex};
+    return PacingStats{
+        .frame_interval       = microseconds(_frame_interval),
+        .transfer_jitter      = microseconds(_transfer_jitter),
+        .release_jitter       = microseconds(_release_jitter),
+        .late_frames_count    = _late_frames_count,
+        .skipped_frames_count = _skipped_frames_count,
+    };
+}
+
+auto FramePacer::delay() const -> std::chrono::nanoseconds
+{
+    return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(std::clamp(_settings.delay_in_frames, 1.f, 2.f) * _frame_interval)};
+}
+
+void FramePacer::push(std::shared_ptr<Image const> const& image, std::chrono::steady_clock::time_point arrival_time)
+{
+    std::scoped_lock lock{_mutex};
+    if (!_settings.enabled)
+        return;
+
+    auto const capture_time  = image->metadata().device_timestamp.value_or(image->metadata().timestamp);
+    auto const transfer_time = nanoseconds(arrival_time - capture_time);
+    if (!_last_capture_time)
+    {
+        _transfer_time = transfer_time;
+    }
+    else
+    {
+        auto const interval = nanoseconds(capture_time - *_last_capture_time);
+        if (_frame_interval == 0.)
+            _frame_interval = interval;
+        else if (interval > 0. && interval < 4. * _frame_interval) // Ignore the gaps, e.g. when the camera stopped sending frames for a while
+            _frame_interval = smoothed(_frame_interval, interval);
+        _transfer_jitter = smoothed(_transfer_jitter, std::abs(transfer_time - _transfer_time));
+        _transfer_time   = smoothed(_transfer_time, transfer_time);
+    }
+    _last_capture_time = capture_time;
+
+    auto release_time = capture_time + delay();
+    if (release_time < arrival_time)
+    {
+        _late_frames_count++;
+        release_time = arrival_time;
+    }
+    if (_last_release_time)
+        release_time = std::max(release_time, *_last_release_time); // The timestamps of some drivers are not perfectly monotonic
+    _last_release_time = release_time;
+
+    _pending_frames.push_back({image, release_time});
+    while (_pending_frames.size() > 3) // We only need to hold up to 2 frames, plus the one that just arrived
+    {
+        _pending_frames.pop_front();
+        _skipped_frames_count++;
+    }
+}
+
+auto FramePacer::release(std::chrono::steady_clock::time_point now) -> std::shared_ptr<Image const>
+{
+    std::scoped_lock lock{_mutex};
+    size_t           released_frames_count = 0;
+    while (!_pending_frames.empty() && _pending_frames.front().release_time <= now)
+    {
+        _current_frame = std::move(_pending_frames.front().image);
+        _pending_frames.pop_front();
+        released_frames_count++;
+    }
+    if (released_frames_count == 0)
+        return _current_frame;
+
+    _skipped_frames_count += released_frames_count - 1; // Only the most recent one will ever be returned
+    if (_last_new_frame_time && _frame_interval > 0.)
+    {
+        auto const expected_interval = _frame_interval * static_cast<double>(released_frames_count);
+        _release_jitter              = smoothed(_release_jitter, std::abs(nanoseconds(now - *_last_new_frame_time) - expected_interval));
+    }
+    _last_new_frame_time = now;
+    return _current_frame;
+}
+
+void FramePacer::reset()
+{
+    std::scoped_lock lock{_mutex};
+    _pending_frames.clear();
+    _current_frame.reset();
+    _last_capture_time.reset();
+    _last_release_time.reset();
+    _last_new_frame_time.reset();
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "../Image.hpp"
+#include "../PacingSettings.hpp"
+
+namespace wcam::internal {
+
+/// Holds the frames of a subscription for a short time, and releases them at the same regular cadence at which they were captured (see PacingSettings)
+class FramePacer {
+public:
+    [[nodiscard]] auto settings() const -> PacingSettings;
+    void               set_settings(PacingSettings);
+    [[nodiscard]] auto stats() const -> PacingStats;
+
+    /// Called on the capture thread for each new image. Does nothing when pacing is disabled.
+    void push(std::shared_ptr<Image const> const&, std::chrono::steady_clock::time_point arrival_time);
+    /// The most recent frame that is due at `now`, or nullptr if no frame is due yet.
+    [[nodiscard]] auto release(std::chrono::steady_clock::time_point now) -> std::shared_ptr<Image const>;
+    /// Forgets the frames, e.g. when the capture is restarted, so that we never release a frame of the previous capture
+    void               reset();
+
+private:
+    [[nodiscard]] auto delay() const -> std::chrono::nanoseconds;
+
+private:
+    struct PendingFrame {
+        std::shared_ptr<Image const>          image;
+        std::chrono::steady_clock::time_point release_time;
+    };
+
+    PacingSettings               _settings{};
+    std::deque<PendingFrame>     _pending_frames{};
+    std::shared_ptr<Image const> _current_frame{};
+
+    std::optional<std::chrono::steady_clock::time_point> _last_capture_time{};
+    std::optional<std::chrono::steady_clock::time_point> _last_release_time{};
+    std::optional<std::chrono::steady_clock::time_point> _last_new_frame_time{}; // When release() last returned a new frame
+    double                                               _frame_interval{0.};    // In nanoseconds, averaged over the last few frames
+    double                                               _transfer_time{0.};     // In nanoseconds, averaged over the last few frames
+    double                                               _transfer_jitter{0.};   // In nanoseconds
+    double                                               _release_jitter{0.};    // In nanoseconds
+    uint64_t                                             _late_frames_count{0};
+    uint64_t                                             _skipped_frames_count{0};
+
+    mutable std::mutex _mutex{};
+};
+
+} // namespace wcam::internal
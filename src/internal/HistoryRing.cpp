@@ -0,0 +1,192 @@
+#include "HistoryRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+#include "ImageFactory.hpp"
+#include "WorkStealingPool.hpp"
+#include "demosaic.hpp"
+#include "grayscale.hpp"
+#include "mjpeg.hpp"
+
+namespace wcam::internal {
+
+void HistoryRing::push(std::chrono::steady_clock::time_point timestamp, HistoryFrameFormat format, uint8_t const* data, size_t data_size, Resolution resolution, FirstRowIs row_order, HistorySettings const& settings)
+{
+    auto copy = std::shared_ptr<uint8_t[]>(new uint8_t[data_size]); // NOLINT(*c-arrays, *owning-memory) Not std::make_shared_for_overwrite(), which is missing from the libc++ of older macOS versions
+    std::memcpy(copy.get(), data, data_size);
+
+    std::scoped_lock lock{_mutex};
+    _frames.push_back(HistoryFrame{
+        .timestamp  = timestamp,
+        .format     = format,
+        .resolution = resolution,
+        .row_order  = row_order,
+        .data       = std::shared_ptr<uint8_t const>{copy, copy.get()},
+        .data_size  = data_size,
+    });
+    _bytes_count += data_size;
+    discard_old_frames(settings, std::chrono::steady_clock::now());
+}
+
+void HistoryRing::discard_old_frames(HistorySettings const& settings, std::chrono::steady_clock::time_point now)
+{
+    while (!_frames.empty()
+           && (_bytes_count > settings.max_bytes || now - _frames.front().timestamp > settings.duration))
+    {
+        _bytes_count -= _frames.front().data_size;
+        _frames.pop_front();
+    }
+}
+
+auto HistoryRing::extract(std::chrono::milliseconds duration) const -> std::vector<HistoryFrame>
+{
+    auto const       now = std::chrono::steady_clock::now();
+    std::scoped_lock lock{_mutex};
+    auto const       first_frame = std::find_if(_frames.begin(), _frames.end(), [&](HistoryFrame const& frame) {
+        return now - frame.timestamp <= duration;
+    });
+    return std::vector<HistoryFrame>(first_frame, _frames.end());
+}
+
+void HistoryRing::clear()
+{
+    std::scoped_lock lock{_mutex};
+    _frames.clear();
+    _bytes_count = 0;
+}
+
+auto HistoryManager::ring(DeviceId const& id) -> HistoryRing&
+{
+    std::scoped_lock lock{_mutex};
+    auto&            ring = _rings[id];
+    if (!ring)
+        ring = std::make_unique<HistoryRing>();
+    return *ring;
+}
+
+static auto decode(HistoryFrame const& frame) -> MaybeImage
+{
+    auto image = image_factory().make_image();
+    switch (frame.format)
+    {
+    case HistoryFrameFormat::MJPEG:
+    {
+#if defined(__linux__)
+        auto decoded_image = mjpeg_to_rgb(frame.data.get(), frame.data_size, 1);
+        if (!decoded_image)
+            return Error_Unknown{"The MJPEG frame is corrupted"};
+        image->set_data(ImageDataView<RGB24>{std::move(decoded_image->rgb_data), decoded_image->resolution.pixels_count() * 3, decoded_image->resolution, frame.row_order});
+        break;
+#else
+        return Error_Unknown{"MJPEG frames can only be decoded on Linux"}; // This is the only platform where we capture MJPEG frames anyways
+#endif
+    }
+    case HistoryFrameFormat::YUYV:
+    {
+        image->set_data(ImageDataView<YUYV>{frame.data, frame.data_size, frame.resolution, frame.row_order});
+        break;
+    }
+    case HistoryFrameFormat::BGR24:
+    {
+        image->set_data(ImageDataView<BGR24>{frame.data, frame.data_size, frame.resolution, frame.row_order});
+        break;
+    }
+    case HistoryFrameFormat::NV12:
+    {
+        image->set_data(ImageDataView<NV12>{frame.data, frame.data_size, frame.resolution, frame.row_order});
+        break;
+    }
+    case HistoryFrameFormat::I420:
+    {
+        auto const* y_plane = frame.data.get();
+        auto const* u_plane = y_plane + frame.resolution.pixels_count();     // NOLINT(*pointer-arithmetic)
+        auto const* v_plane = u_plane + frame.resolution.pixels_count() / 4; // NOLINT(*pointer-arithmetic)
+        auto const  width   = static_cast<size_t>(frame.resolution.width());
+        image->set_data(ImagePlanesView<I420>{{ImagePlane{y_plane, width}, ImagePlane{u_plane, width / 2}, ImagePlane{v_plane, width / 2}}, frame.resolution, frame.row_order});
+        break;
+    }
+    case HistoryFrameFormat::BayerRGGB8:
+    case HistoryFrameFormat::BayerBGGR8:
+    case HistoryFrameFormat::BayerGRBG8:
+    case HistoryFrameFormat::BayerGBRG8:
+    case HistoryFrameFormat::BayerRGGB10P:
+    case HistoryFrameFormat::BayerBGGR10P:
+    case HistoryFrameFormat::BayerGRBG10P:
+    case HistoryFrameFormat::BayerGBRG10P:
+    {
+        // The frames are stored exactly as the driver sent them, so the rows are evenly spread over the whole buffer
+        // We don't know which camera the frame comes from, so we use the default settings
+        if (!set_bayer_data(*image, frame.data.get(), frame.data_size, frame.data_size / frame.resolution.height(), frame.resolution, frame.row_order, *bayer_format(frame.format), BayerSettings{}))
+            return Error_Unknown{"The frame is truncated"};
+        break;
+    }
+    case HistoryFrameFormat::GRAY8:
+    case HistoryFrameFormat::GRAY16:
+    case HistoryFrameFormat::GRAY10:
+    case HistoryFrameFormat::GRAY10P:
+    {
+        if (!set_gray_data(*image, frame.data.get(), frame.data_size, frame.data_size / frame.resolution.height(), frame.resolution, frame.row_order, frame.format)) // The frames are stored exactly as the driver sent them, so the rows are evenly spread over the whole buffer
+            return Error_Unknown{"The frame is truncated"};
+        break;
+    }
+    }
+    return image;
+}
+
+namespace {
+/// Shared between the calling thread and the workers that help it
+struct DecodingJob {
+    explicit DecodingJob(std::vector<HistoryFrame> frames_to_decode)
+        : frames{std::move(frames_to_decode)}
+        , images(frames.size(), ImageNotInitYet{})
+    {}
+
+    std::vector<HistoryFrame> frames;
+    std::vector<MaybeImage>   images;
+    std::atomic<size_t>       next_frame_index{0};
+    std::atomic<size_t>       decoded_frames_count{0};
+    std::mutex                mutex{};
+    std::condition_variable   all_frames_decoded{};
+
+    void decode_frames()
+    {
+        while (true)
+        {
+            auto const index = next_frame_index.fetch_add(1);
+            if (index >= frames.size())
+                return;
+            images[index] = decode(frames[index]);
+            if (decoded_frames_count.fetch_add(1) + 1 == frames.size())
+            {
+                std::scoped_lock lock{mutex};
+                all_frames_decoded.notify_all();
+            }
+        }
+    }
+};
+} // namespace
+
+auto decode_history_frames(std::vector<HistoryFrame> const& frames) -> std::vector<MaybeImage>
+{
+    if (frames.empty())
+        return {};
+
+    auto job = std::make_shared<DecodingJob>(frames);
+    // The calling thread also decodes frames, so that we can't deadlock even if all the workers are busy (or if we are called from a pipeline stage)
+    auto const helpers_count = std::min<size_t>(frames.size() - 1, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < helpers_count; ++i)
+    {
+        work_stealing_pool().submit([job]() {
+            job->decode_frames();
+        });
+    }
+    job->decode_frames();
+
+    std::unique_lock lock{job->mutex};
+    job->all_frames_decoded.wait(lock, [&]() { return job->decoded_frames_count.load() == job->frames.size(); });
+    return std::move(job->images);
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../DeviceId.hpp"
+#include "../History.hpp"
+#include "../MaybeImage.hpp"
+
+namespace wcam::internal {
+
+/// The history of one camera. See HistorySettings.
+class HistoryRing {
+public:
+    /// Copies the data, and discards the frames that don't fit in the settings anymore
+    void push(std::chrono::steady_clock::time_point timestamp, HistoryFrameFormat, uint8_t const* data, size_t data_size, Resolution, FirstRowIs, HistorySettings const&);
+    /// The frames received during the last `duration`, from the oldest to the most recent
+    [[nodiscard]] auto extract(std::chrono::milliseconds duration) const -> std::vector<HistoryFrame>;
+    void               clear();
+
+private:
+    void discard_old_frames(HistorySettings const&, std::chrono::steady_clock::time_point now);
+
+private:
+    std::deque<HistoryFrame> _frames{};
+    size_t                   _bytes_count{0};
+    mutable std::mutex       _mutex{};
+};
+
+class HistoryManager {
+public:
+    [[nodiscard]] auto ring(DeviceId const&) -> HistoryRing&;
+
+private:
+    std::unordered_map<DeviceId, std::unique_ptr<HistoryRing>> _rings{};
+    std::mutex                                                 _mutex{};
+};
+
+inline auto history_manager() -> HistoryManager& // Not part of the Manager, so that the history survives even if the library is stopped (e.g. when the event that you want to inspect was the camera being unplugged)
+{
+    static auto instance = HistoryManager{};
+    return instance;
+}
+
+/// Decodes the frames in parallel, on the work stealing pool and on the calling thread
+[[nodiscard]] auto decode_history_frames(std::vector<HistoryFrame> const&) -> std::vector<MaybeImage>;
+
+} // namespace wcam::internal
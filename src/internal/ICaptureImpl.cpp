@@ -1,4 +1,9 @@
 #include "ICaptureImpl.hpp"
+#include "../DuplicateFramesPolicy.hpp"
+#include "DeviceSettingsManager.hpp"
+#include "HistoryRing.hpp"
+#include "ImageFactory.hpp"
+#include "hash_frame.hpp"
 
 namespace wcam::internal {
 
@@ -8,10 +13,81 @@ auto ICaptureImpl::image() -> MaybeImage
     return _image;
 }
 
+auto ICaptureImpl::make_image() -> std::shared_ptr<Image>
+{
+    auto image       = image_factory().make_image();
+    auto subscribers = _subscriptions->crop_subscribers();
+    std::erase_if(subscribers, [](std::shared_ptr<CropSubscriber> const& subscriber) {
+        return !subscriber->wants_frame();
+    });
+    if (subscribers.empty())
+    {
+        _cropping_image.reset();
+        return image;
+    }
+    _cropping_image = std::make_shared<CroppingImage>(std::move(image), subscribers);
+    return _cropping_image;
+}
+
 void ICaptureImpl::set_image(MaybeImage image)
 {
-    std::unique_lock lock{_mutex};
-    _image = std::move(image);
+    auto* const new_image = std::get_if<std::shared_ptr<Image const>>(&image);
+    if (_cropping_image && new_image && new_image->get() == _cropping_image.get())
+        *new_image = _cropping_image->publish_crops(); // The consumers of this camera get the image of the camera, not the CroppingImage
+    _cropping_image.reset();
+    if (!new_image)
+    {
+        for (auto const& subscriber : _subscriptions->crop_subscribers()) // The virtual cameras are in error too
+            subscriber->on_new_image(image);
+    }
+    auto const pipeline_image = new_image ? *new_image : nullptr; // Copy it before we move the image
+    {
+        std::unique_lock lock{_mutex};
+        _image = std::move(image);
+    }
+    if (pipeline_image)
+        _subscriptions->on_new_image(pipeline_image);
+}
+
+auto ICaptureImpl::is_frame_wanted() -> bool
+{
+    auto const max_fps = _subscriptions->max_fps();
+    if (!max_fps)
+        return true;
+    return _rate_limiter.should_deliver(*max_fps, std::chrono::steady_clock::now());
+}
+
+auto ICaptureImpl::is_duplicate_frame(uint8_t const* data, size_t size) -> bool
+{
+    auto const policy = device_settings<DuplicateFramesPolicy>().settings(_id);
+    if (policy == DuplicateFramesPolicy::Deliver)
+    {
+        _previous_frame_hash.reset();
+        return false;
+    }
+
+    auto const hash         = policy == DuplicateFramesPolicy::SkipSampled ? hash_frame_sampled(data, size) : hash_frame(data, size);
+    bool const is_duplicate = _previous_frame_hash == hash;
+    _previous_frame_hash    = hash;
+    return is_duplicate;
+}
+
+auto ICaptureImpl::admit_frame(size_t bytes, unsigned int max_downscale) -> std::optional<unsigned int>
+{
+    return memory_budgets().admit_frame(_id, *_memory_account, bytes, max_downscale);
+}
+
+auto ICaptureImpl::is_history_enabled() const -> bool
+{
+    return device_settings<HistorySettings>().settings(_id).enabled;
+}
+
+void ICaptureImpl::record_in_history(std::chrono::steady_clock::time_point timestamp, HistoryFrameFormat format, uint8_t const* data, size_t size, Resolution resolution, FirstRowIs row_order)
+{
+    auto const settings = device_settings<HistorySettings>().settings(_id);
+    if (!settings.enabled)
+        return;
+    history_manager().ring(_id).push(timestamp, format, data, size, resolution, row_order, settings);
 }
 
 } // namespace wcam::internal
\ No newline at end of file
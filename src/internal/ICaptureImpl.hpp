@@ -1,7 +1,21 @@
 #pragma once
+#include <atomic>
 #include <exception>
+#include <future>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <vector>
+#include "../Burst.hpp"
+#include "../DeviceId.hpp"
+#include "../History.hpp"
 #include "../MaybeImage.hpp"
+#include "../PooledBuffer.hpp"
+#include "../Still.hpp"
+#include "CroppingImage.hpp"
+#include "MemoryBudgetManager.hpp"
+#include "MotionGate.hpp"
+#include "Subscriptions.hpp"
 
 namespace wcam::internal {
 
@@ -13,10 +27,21 @@ public:
     CaptureError capture_error;
 };
 
+struct BurstRequest {
+    size_t                    frames_count;
+    std::vector<PooledBuffer> buffers;
+    std::promise<MaybeBurst>  promise;
+};
+
 class ICaptureImpl {
 public:
     /// Throws a CaptureException if the creation of the Capture fails
-    ICaptureImpl()                                           = default;
+    ICaptureImpl(DeviceId id, std::shared_ptr<Subscriptions const> subscriptions)
+        : _id{std::move(id)}
+        , _subscriptions{std::move(subscriptions)}
+        , _motion_gate{_id}
+        , _memory_account{memory_budgets().account(_id)}
+    {}
     virtual ~ICaptureImpl()                                  = default;
     ICaptureImpl(ICaptureImpl const&)                        = delete;
     auto operator=(ICaptureImpl const&) -> ICaptureImpl&     = delete;
@@ -25,12 +50,54 @@ public:
 
     auto image() -> MaybeImage;
 
+    /// The Manager will reconfigure this capture, or destroy it and create a new one
+    [[nodiscard]] auto needs_restart() const -> bool { return _needs_restart.load(); }
+    void               request_restart() { _needs_restart.store(true); } // The capture can't restart itself, because this joins its own thread
+    /// Switches to another resolution without destroying the capture, which is much faster and avoids a gap in the frames.
+    /// Returns false if the backend doesn't support it, in which case the capture needs to be recreated.
+    /// Throws a CaptureException if it fails, in which case the capture can't be used anymore.
+    [[nodiscard]] virtual auto reconfigure(Resolution const&) -> bool { return false; }
+    /// Captures one frame at the given resolution, and then goes back to the current one. Must only be called from the Manager thread.
+    [[nodiscard]] virtual auto capture_still(Resolution const&) -> MaybeStill { return Error_Unknown{"Still capture is not supported on this platform yet"}; }
+    /// The frames are captured asynchronously by the capture thread, which fulfills the promise once they are all there
+    virtual void               start_burst(BurstRequest request) { request.promise.set_value(Error_Unknown{"Burst capture is not supported on this platform yet"}); }
+
 protected:
-    void set_image(MaybeImage);
+    /// Creates the image that you will fill and then give to set_image(). When virtual cameras show a region of this camera (see add_virtual_webcam()), it also fills their images.
+    [[nodiscard]] auto make_image() -> std::shared_ptr<Image>;
+    void               set_image(MaybeImage);
+    /// Returns false when none of the consumers wants a new frame yet (because they all have a max fps), in which case the frame should be dropped before being decoded
+    [[nodiscard]] auto is_frame_wanted() -> bool;
+    /// Returns true iff the raw data of the frame is the same as the one of the previous frame, and the DuplicateFramesPolicy asks to drop those duplicates
+    [[nodiscard]] auto is_duplicate_frame(uint8_t const* data, size_t size) -> bool;
+    void               clear_restart_request() { _needs_restart.store(false); }
+    [[nodiscard]] auto id() const -> DeviceId const& { return _id; }
+    /// Must only be used from the capture thread
+    [[nodiscard]] auto motion_gate() -> MotionGate& { return _motion_gate; }
+    /// Must be called before decoding a frame that will need `bytes` of memory. See MemoryBudgetManager::admit_frame().
+    [[nodiscard]] auto admit_frame(size_t bytes, unsigned int max_downscale) -> std::optional<unsigned int>;
+    /// Allows you to skip the preparation of the data that you would give to record_in_history()
+    [[nodiscard]] auto is_history_enabled() const -> bool;
+    /// Keeps a copy of the raw frame in the history of the camera, if it is enabled (see HistorySettings)
+    void               record_in_history(std::chrono::steady_clock::time_point timestamp, HistoryFrameFormat, uint8_t const* data, size_t size, Resolution, FirstRowIs);
+    /// std::nullopt when none of the consumers wants to receive the frames in slices (see SharedWebcam::set_slice_callback())
+    [[nodiscard]] auto rows_per_slice() const -> std::optional<uint32_t> { return _subscriptions->rows_per_slice(); }
+    void               publish_slice(FrameSlice const& slice) const { _subscriptions->on_new_slice(slice); }
+    /// The buffers allocated by the calling thread while the returned object is alive are counted in the memory usage of this capture
+    [[nodiscard]] auto count_allocations() const -> ScopedMemoryAccount { return ScopedMemoryAccount{_memory_account}; }
 
 private:
-    MaybeImage _image{ImageNotInitYet{}};
-    std::mutex _mutex{};
+    MaybeImage        _image{ImageNotInitYet{}};
+    std::mutex        _mutex{};
+    std::atomic<bool> _needs_restart{false};
+
+    DeviceId                             _id;
+    std::shared_ptr<Subscriptions const> _subscriptions;
+    RateLimiter                          _rate_limiter{};
+    std::optional<uint64_t>              _previous_frame_hash{};
+    MotionGate                           _motion_gate;
+    std::shared_ptr<MemoryAccount>       _memory_account;
+    std::shared_ptr<CroppingImage>       _cropping_image{}; // The last image returned by make_image(), when it needs to fill the images of some virtual cameras
 };
 
 } // namespace wcam::internal
\ No newline at end of file
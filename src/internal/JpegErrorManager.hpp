@@ -0,0 +1,52 @@
+#pragma once
+#if defined(__linux__)
+#include <csetjmp>
+#include <cstdio>
+#include <string>
+#include <jpeglib.h> // Must come after <cstdio>
+
+namespace wcam::internal {
+
+/// The default error manager of libjpeg calls exit() when a frame is corrupted or a file can't be written, which would kill the whole application.
+/// This one jumps back to catch_jpeg_errors() instead.
+class JpegErrorManager {
+public:
+    /// Must be given to the `err` field of the libjpeg struct, before calling jpeg_create_compress() / jpeg_create_decompress()
+    auto install() -> jpeg_error_mgr*
+    {
+        jpeg_std_error(&_manager);
+        _manager.error_exit = &JpegErrorManager::error_exit;
+        return &_manager;
+    }
+
+    /// Runs `function`, which calls libjpeg, and returns false if libjpeg reported an error. You must then call jpeg_destroy_compress() / jpeg_destroy_decompress().
+    /// Since we leave libjpeg with a longjmp, no object with a destructor must be alive in `function` while it calls libjpeg: create them before calling catch_jpeg_errors().
+    template<typename Function>
+    auto catch_jpeg_errors(Function&& function) -> bool
+    {
+        if (setjmp(_jump_buffer) != 0) // NOLINT(*setjmp*)
+            return false;
+        function();
+        return true;
+    }
+
+    /// The message of the last error
+    [[nodiscard]] auto message() const -> std::string { return _message; } // NOLINT(*array-to-pointer-decay)
+
+private:
+    static void error_exit(j_common_ptr info)
+    {
+        auto* const self = reinterpret_cast<JpegErrorManager*>(info->err); // NOLINT(*reinterpret-cast) _manager is the first member, so it has the same address as the JpegErrorManager
+        info->err->format_message(info, self->_message);                   // NOLINT(*array-to-pointer-decay)
+        std::longjmp(self->_jump_buffer, 1);                               // NOLINT(*setjmp*)
+    }
+
+private:
+    jpeg_error_mgr _manager{}; // Must stay the first member, see error_exit()
+    std::jmp_buf   _jump_buffer{};
+    char           _message[JMSG_LENGTH_MAX]{}; // NOLINT(*c-arrays)
+};
+
+} // namespace wcam::internal
+
+#endif
@@ -1,7 +1,11 @@
 #include "Manager.hpp"
 #include <mutex>
 #include <variant>
+#include "AdaptiveQualityManager.hpp"
+#include "BackendsRegistry.hpp"
 #include "ResolutionsManager.hpp"
+#include "ThreadSettingsManager.hpp"
+#include "VirtualWebcamsManager.hpp"
 #include "WebcamRequest.hpp"
 
 namespace wcam::internal {
@@ -32,14 +36,19 @@ Manager::~Manager()
 void Manager::thread_job(Manager& self)
 {
     while (!self._wants_to_stop_thread.load())
+    {
+        thread_settings_manager().apply_settings_if_they_changed(ThreadRole::Manager);
         self.update();
+    }
 }
 
 auto grab_all_infos_impl() -> std::vector<Info>;
 
 static auto grab_all_infos() -> std::vector<Info>
 {
-    auto list_webcams_infos = internal::grab_all_infos_impl();
+    auto       list_webcams_infos = internal::grab_all_infos_impl();
+    auto const backends_infos     = backends_registry().infos();
+    list_webcams_infos.insert(list_webcams_infos.end(), backends_infos.begin(), backends_infos.end());
     for (auto& webcam_info : list_webcams_infos)
     {
         auto& resolutions = webcam_info.resolutions;
@@ -68,11 +77,11 @@ auto Manager::open_or_get_webcam(DeviceId const& id) -> SharedWebcam
     {
         std::shared_ptr<WebcamRequest> const request = it->second.lock();
         if (request) // A capture is still alive, we don't want to recreate a new one (we can't capture the same webcam twice anyways)
-            return SharedWebcam{request};
+            return SharedWebcam{request, request->subscriptions()->add()};
     }
     auto const request    = std::make_shared<WebcamRequest>(id);
     _current_requests[id] = request; // Store a weak_ptr in the current requests
-    return SharedWebcam{request};
+    return SharedWebcam{request, request->subscriptions()->add()};
 }
 
 /// Iterates over the map + might modify an element of the map
@@ -86,7 +95,10 @@ void Manager::request_a_restart_of_the_capture_if_it_exists(DeviceId const& id)
     auto const request = it->second.lock();
     if (!request)
         return;
-    request->maybe_capture() = CaptureNotInitYet{};
+    if (auto* const capture = std::get_if<Capture>(&request->maybe_capture()))
+        capture->request_restart(); // Let the Manager thread reconfigure it, without interrupting the stream of images
+    else
+        request->maybe_capture() = CaptureNotInitYet{};
 }
 
 auto Manager::default_resolution(DeviceId const& id) const -> Resolution
@@ -108,11 +120,24 @@ auto Manager::is_plugged_in(DeviceId const& id) const -> bool
            });
 }
 
+auto Manager::resolutions(DeviceId const& id) const -> std::vector<Resolution>
+{
+    std::scoped_lock lock{_infos_mutex};
+    auto const       it = std::find_if(_infos.begin(), _infos.end(), [&](Info const& info) {
+        return info.id == id;
+    });
+    if (it == _infos.end())
+        return {};
+    return it->resolutions;
+}
+
 /// Iterates over the map + might modify an element of the map
 void Manager::update()
 {
     {
-        auto infos = grab_all_infos();
+        auto       infos         = grab_all_infos();
+        auto const virtual_infos = virtual_webcams_manager().infos(infos);
+        infos.insert(infos.end(), virtual_infos.begin(), virtual_infos.end());
 
         std::scoped_lock lock{_infos_mutex};
         _infos = std::move(infos);
@@ -132,18 +157,48 @@ void Manager::update()
             if (!is_plugged_in(request->id()))
             {
                 request->maybe_capture() = Error_WebcamUnplugged{};
+                request->capture_pending_stills();
+                request->start_pending_bursts();
                 continue;
             }
-            if (std::holds_alternative<Capture>(request->maybe_capture()))
+            request->capture_pending_stills();
+            request->start_pending_bursts();
+            if (auto const* capture = std::get_if<Capture>(&request->maybe_capture());
+                capture && !capture->needs_restart())
+            {
                 continue; // The capture is valid, nothing to do
+            }
+            if (request->is_waiting_for_usb_bandwidth())
+                continue; // Retrying now would fail again, and hammering the driver doesn't help
             // Otherwise, the webcam is plugged in but the capture is not valid, so we should try to (re)create it
+            auto const on_error = [&](CaptureError const& error) {
+                request->maybe_capture() = error;
+                if (std::holds_alternative<Error_NotEnoughUsbBandwidth>(error))
+                    request->remember_usb_bandwidth_failure();
+            };
+            auto const resolution = adaptive_quality_manager().capture_resolution(request->id(), resolutions_manager().selected_resolution(request->id()), resolutions(request->id()));
+            if (auto* const capture = std::get_if<Capture>(&request->maybe_capture()))
+            {
+                request->keep_last_image_during_restart();
+                try
+                {
+                    if (capture->reconfigure(resolution))
+                        continue; // The capture was restarted in place, which is much faster than recreating it
+                }
+                catch (CaptureException const& e)
+                {
+                    on_error(e.capture_error);
+                    continue;
+                }
+                request->maybe_capture() = CaptureNotInitYet{}; // Destroy the previous capture before creating the new one, because they can't both use the camera at the same time
+            }
             try
             {
-                request->maybe_capture() = Capture{request->id(), resolutions_manager().selected_resolution(request->id())};
+                request->maybe_capture() = Capture{request->id(), resolution, request->subscriptions()};
             }
             catch (CaptureException const& e)
             {
-                request->maybe_capture() = e.capture_error;
+                on_error(e.capture_error);
             }
         }
     }
@@ -29,6 +29,7 @@ public:
 
 private:
     auto is_plugged_in(DeviceId const& id) const -> bool;
+    auto resolutions(DeviceId const& id) const -> std::vector<Resolution>;
 
     static void thread_job(Manager& self);
 
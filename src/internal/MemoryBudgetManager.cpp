@@ -0,0 +1,152 @@
+#include "MemoryBudgetManager.hpp"
+#include <utility>
+#include "BufferPool.hpp"
+#include "DeviceSettingsManager.hpp"
+
+namespace wcam::internal {
+
+void MemoryAccount::on_allocate(size_t bytes)
+{
+    auto const bytes_in_use = _bytes_in_use.fetch_add(bytes) + bytes;
+    auto       peak         = _peak_bytes_in_use.load();
+    while (peak < bytes_in_use && !_peak_bytes_in_use.compare_exchange_weak(peak, bytes_in_use))
+    {
+    }
+}
+
+void MemoryAccount::on_free(size_t bytes)
+{
+    _bytes_in_use.fetch_sub(bytes);
+}
+
+auto MemoryAccount::usage() const -> MemoryUsage
+{
+    return MemoryUsage{
+        .bytes_in_use      = _bytes_in_use.load(),
+        .peak_bytes_in_use = _peak_bytes_in_use.load(),
+        .frames_dropped    = _frames_dropped.load(),
+        .frames_degraded   = _frames_degraded.load(),
+        .frames_blocked    = _frames_blocked.load(),
+    };
+}
+
+thread_local std::shared_ptr<MemoryAccount> current_memory_account{}; // NOLINT(*avoid-non-const-global-variables)
+
+ScopedMemoryAccount::ScopedMemoryAccount(std::shared_ptr<MemoryAccount> account)
+    : _previous_account{std::exchange(current_memory_account, std::move(account))}
+{
+}
+
+ScopedMemoryAccount::~ScopedMemoryAccount()
+{
+    current_memory_account = std::move(_previous_account);
+}
+
+auto ScopedMemoryAccount::current() -> std::shared_ptr<MemoryAccount> const&
+{
+    return current_memory_account;
+}
+
+auto MemoryBudgetManager::global_budget() const -> MemoryBudget
+{
+    std::scoped_lock lock{_mutex};
+    return _global_budget;
+}
+
+void MemoryBudgetManager::set_global_budget(MemoryBudget budget)
+{
+    {
+        std::scoped_lock lock{_mutex};
+        _global_budget = budget;
+    }
+    if (budget.max_bytes && _global_account.bytes_in_use() + buffer_pool().cached_bytes() > *budget.max_bytes)
+        buffer_pool().release_cached_memory();
+    on_memory_freed(); // The new budget might be bigger, and allow the captures that are waiting to continue
+}
+
+auto MemoryBudgetManager::account(DeviceId const& id) -> std::shared_ptr<MemoryAccount>
+{
+    std::scoped_lock lock{_mutex};
+    auto&            account = _accounts[id];
+    if (!account)
+        account = std::make_shared<MemoryAccount>();
+    return account;
+}
+
+auto MemoryBudgetManager::fits_in_global_budget(size_t bytes, MemoryBudget const& budget) const -> bool
+{
+    // The cached memory is not taken into account, because the pool will release it if needed
+    return !budget.max_bytes || _global_account.bytes_in_use() + bytes <= *budget.max_bytes;
+}
+
+static auto fits_in_device_budget(size_t bytes, MemoryBudget const& budget, MemoryAccount const& account) -> bool
+{
+    return !budget.max_bytes || account.bytes_in_use() + bytes <= *budget.max_bytes;
+}
+
+auto MemoryBudgetManager::admit_frame(DeviceId const& id, MemoryAccount& account, size_t bytes, unsigned int max_downscale) -> std::optional<unsigned int>
+{
+    auto const device_budget = device_settings<MemoryBudget>().settings(id);
+    auto const global_budget = this->global_budget();
+    auto const fits          = [&](size_t size) {
+        return fits_in_device_budget(size, device_budget, account)
+               && fits_in_global_budget(size, global_budget);
+    };
+    if (fits(bytes))
+        return 1;
+
+    auto const drop_frame = [&]() -> std::optional<unsigned int> {
+        account.count_dropped_frame();
+        _global_account.count_dropped_frame();
+        return std::nullopt;
+    };
+    auto const& exceeded_budget = fits_in_device_budget(bytes, device_budget, account) ? global_budget : device_budget; // When both are exceeded the device budget wins, because it is the most specific
+    switch (exceeded_budget.policy)
+    {
+    case MemoryBudgetPolicy::Drop:
+    {
+        return drop_frame();
+    }
+    case MemoryBudgetPolicy::Degrade:
+    {
+        for (unsigned int const scale : {2u, 4u, 8u})
+        {
+            if (scale <= max_downscale && fits(bytes / (scale * scale)))
+            {
+                account.count_degraded_frame();
+                _global_account.count_degraded_frame();
+                return scale;
+            }
+        }
+        return drop_frame();
+    }
+    case MemoryBudgetPolicy::Block:
+    {
+        account.count_blocked_frame();
+        _global_account.count_blocked_frame();
+        _waiting_captures_count.fetch_add(1);
+        bool has_room{};
+        {
+            std::unique_lock lock{_wait_mutex};
+            has_room = _memory_freed.wait_for(lock, exceeded_budget.max_block_duration, [&]() { return fits(bytes); });
+        }
+        _waiting_captures_count.fetch_sub(1);
+        if (!has_room)
+            return drop_frame();
+        return 1;
+    }
+    }
+    return drop_frame();
+}
+
+void MemoryBudgetManager::on_memory_freed()
+{
+    if (_waiting_captures_count.load() == 0)
+        return;
+    {
+        std::scoped_lock lock{_wait_mutex}; // Makes sure that a capture that has just checked the budget is actually waiting, otherwise it would miss our notification
+    }
+    _memory_freed.notify_all();
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include "../DeviceId.hpp"
+#include "../MemoryBudget.hpp"
+
+namespace wcam::internal {
+
+/// Keeps track of the memory used by the buffers of a capture (or of all the buffers, for the global account)
+class MemoryAccount {
+public:
+    void               on_allocate(size_t bytes);
+    void               on_free(size_t bytes);
+    [[nodiscard]] auto bytes_in_use() const -> size_t { return _bytes_in_use.load(); }
+
+    void count_dropped_frame() { _frames_dropped.fetch_add(1); }
+    void count_degraded_frame() { _frames_degraded.fetch_add(1); }
+    void count_blocked_frame() { _frames_blocked.fetch_add(1); }
+
+    [[nodiscard]] auto usage() const -> MemoryUsage;
+
+private:
+    std::atomic<size_t>   _bytes_in_use{0};
+    std::atomic<size_t>   _peak_bytes_in_use{0};
+    std::atomic<uint64_t> _frames_dropped{0};
+    std::atomic<uint64_t> _frames_degraded{0};
+    std::atomic<uint64_t> _frames_blocked{0};
+};
+
+/// While this object is alive, the buffers allocated by the current thread are also counted in the given account.
+/// This is how the conversions done in Image::set_data() get attributed to the capture that called it.
+class ScopedMemoryAccount {
+public:
+    explicit ScopedMemoryAccount(std::shared_ptr<MemoryAccount>);
+    ~ScopedMemoryAccount();
+    ScopedMemoryAccount(ScopedMemoryAccount const&)                        = delete;
+    auto operator=(ScopedMemoryAccount const&) -> ScopedMemoryAccount&     = delete;
+    ScopedMemoryAccount(ScopedMemoryAccount&&) noexcept                    = delete;
+    auto operator=(ScopedMemoryAccount&&) noexcept -> ScopedMemoryAccount& = delete;
+
+    [[nodiscard]] static auto current() -> std::shared_ptr<MemoryAccount> const&;
+
+private:
+    std::shared_ptr<MemoryAccount> _previous_account;
+};
+
+class MemoryBudgetManager {
+public:
+    [[nodiscard]] auto global_budget() const -> MemoryBudget;
+    void               set_global_budget(MemoryBudget);
+
+    [[nodiscard]] auto global_account() -> MemoryAccount& { return _global_account; }
+    /// Created the first time it is requested, and then kept forever so that the statistics survive the restarts of the capture
+    [[nodiscard]] auto account(DeviceId const&) -> std::shared_ptr<MemoryAccount>;
+
+    /// To be called before decoding a frame that will need `bytes` of memory. Applies the policy of the budget that would be exceeded, which might block the calling thread.
+    /// Returns the factor by which the width and height of the frame must be divided (1 if the frame fits as is), or std::nullopt if the frame must be dropped.
+    /// `max_downscale` is the largest factor that the caller is able to apply (1 if it can't downscale the frame).
+    [[nodiscard]] auto admit_frame(DeviceId const&, MemoryAccount&, size_t bytes, unsigned int max_downscale) -> std::optional<unsigned int>;
+
+    /// Called each time a buffer is freed, to wake up the captures that are waiting for some memory
+    void on_memory_freed();
+
+private:
+    [[nodiscard]] auto fits_in_global_budget(size_t bytes, MemoryBudget const&) const -> bool;
+
+private:
+    MemoryBudget                                                 _global_budget{};
+    MemoryAccount                                                _global_account{};
+    std::unordered_map<DeviceId, std::shared_ptr<MemoryAccount>> _accounts{};
+    mutable std::mutex                                           _mutex{};
+
+    std::atomic<size_t>     _waiting_captures_count{0};
+    std::mutex              _wait_mutex{};
+    std::condition_variable _memory_freed{};
+};
+
+/// Shared with the BufferPool and its buffers, because they might be freed after the end of main(), once this static has been destroyed (e.g. if the user holds onto an image in a global variable)
+inline auto shared_memory_budgets() -> std::shared_ptr<MemoryBudgetManager> const& // Not part of the Manager, for the same reasons as the ResolutionsManager: we want to remember the settings even when the library is not alive
+{
+    static auto const instance = std::make_shared<MemoryBudgetManager>();
+    return instance;
+}
+
+inline auto memory_budgets() -> MemoryBudgetManager&
+{
+    return *shared_memory_budgets();
+}
+
+} // namespace wcam::internal
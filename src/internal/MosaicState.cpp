@@ -0,0 +1,191 @@
+#include "MosaicState.hpp"
+#include <algorithm>
+#include <cstring>
+#include "ImageFactory.hpp"
+
+namespace wcam::internal {
+
+MosaicState::MosaicState(MosaicLayout layout)
+    : _layout{std::move(layout)}
+    , _tiles(_layout.tiles.size())
+    , _canvas(RGB24::data_length(_layout.resolution), 0)
+{
+    for (size_t i = 0; i < _tiles.size(); ++i)
+    {
+        auto& region  = _layout.tiles[i];
+        region.x      = std::min(region.x, _layout.resolution.width()); // Make sure that we never write outside of the canvas
+        region.y      = std::min(region.y, _layout.resolution.height());
+        region.width  = std::min(region.width, _layout.resolution.width() - region.x);
+        region.height = std::min(region.height, _layout.resolution.height() - region.y);
+
+        _tiles[i].region = region;
+    }
+}
+
+void MosaicState::on_tile_updated(std::shared_ptr<Image const> const& image)
+{
+    std::scoped_lock lock{_image_mutex};
+    if (image->metadata().timestamp > _latest_metadata.timestamp)
+        _latest_metadata = image->metadata();
+    _version.fetch_add(1);
+}
+
+auto MosaicState::buffer_to_publish() -> PublishedBuffer&
+{
+    for (auto& buffer : _published_buffers)
+    {
+        if (buffer.data && buffer.data.use_count() == 1) // No image reads from it anymore (e.g. because the images copy the data they are given)
+            return buffer;
+    }
+    // All the buffers are still read by some images, so we leave one of them to its images and start a new one. Not the latest one, which is more likely to be freed soon.
+    auto& buffer          = _published_buffers[&_published_buffers[0] == _latest_published_buffer ? 1 : 0];
+    buffer.data           = std::shared_ptr<uint8_t[]>(new uint8_t[_canvas.size()]()); // NOLINT(*c-arrays, *owning-memory) Zero-initialized, like the canvas
+    buffer.tiles_versions = std::vector<uint64_t>(_tiles.size(), 0);                  // So that we copy all the tiles that have been written
+    return buffer;
+}
+
+auto MosaicState::image() -> MaybeImage
+{
+    std::scoped_lock lock{_image_mutex};
+    auto const       version = _version.load();
+    if (version == _published_version)
+        return _published_image;
+
+    auto&      buffer        = buffer_to_publish();
+    auto const bytes_per_row = static_cast<size_t>(_layout.resolution.width()) * 3;
+    for (size_t i = 0; i < _tiles.size(); ++i)
+    {
+        auto&            tile = _tiles[i];
+        std::scoped_lock tile_lock{tile.mutex};
+        if (buffer.tiles_versions[i] == tile.version)
+            continue; // The buffer already contains this version of the tile
+        for (uint32_t y = tile.region.y; y < tile.region.y + tile.region.height; ++y)
+        {
+            auto const offset = y * bytes_per_row + static_cast<size_t>(tile.region.x) * 3;
+            std::memcpy(buffer.data.get() + offset, _canvas.data() + offset, static_cast<size_t>(tile.region.width) * 3); // NOLINT(*pointer-arithmetic)
+        }
+        buffer.tiles_versions[i] = tile.version;
+    }
+    _latest_published_buffer = &buffer;
+
+    auto image = image_factory().make_image();
+    image->set_data(ImageDataView<RGB24>{std::shared_ptr<uint8_t const>{buffer.data, buffer.data.get()}, _canvas.size(), _layout.resolution, FirstRowIs::Top});
+    set_frame_metadata(*image, _latest_metadata);
+    _published_image   = std::shared_ptr<Image const>{std::move(image)};
+    _published_version = version;
+    return _published_image;
+}
+
+/// Same conversion as yuyv_to_rgb()
+static auto full_range_yuv_to_rgb(uint8_t y, uint8_t u, uint8_t v) -> Rgb
+{
+    auto const luma = static_cast<int>(y << 8);
+    auto const cb   = static_cast<int>(u - 128);
+    auto const cr   = static_cast<int>(v - 128);
+    return {
+        static_cast<uint8_t>(std::clamp((luma + 359 * cr) >> 8, 0, 255)),
+        static_cast<uint8_t>(std::clamp((luma - 88 * cb - 183 * cr) >> 8, 0, 255)),
+        static_cast<uint8_t>(std::clamp((luma + 454 * cb) >> 8, 0, 255)),
+    };
+}
+
+/// Same conversion as the one that Image uses for NV12 and I420
+static auto video_range_yuv_to_rgb(uint8_t y, uint8_t u, uint8_t v) -> Rgb
+{
+    auto const c = static_cast<int>(y - 16);
+    auto const d = static_cast<int>(u - 128);
+    auto const e = static_cast<int>(v - 128);
+    return {
+        static_cast<uint8_t>(std::clamp((298 * c + 409 * e + 128) >> 8, 0, 255)),
+        static_cast<uint8_t>(std::clamp((298 * c - 100 * d - 208 * e + 128) >> 8, 0, 255)),
+        static_cast<uint8_t>(std::clamp((298 * c + 516 * d + 128) >> 8, 0, 255)),
+    };
+}
+
+void MosaicTileImage::set_data(ImageDataView<RGB24> const& view)
+{
+    auto const bytes_per_row = static_cast<size_t>(view.resolution().width()) * 3;
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto const* pixel = view.data() + row * bytes_per_row + x * 3; // NOLINT(*pointer-arithmetic)
+        return Rgb{pixel[0], pixel[1], pixel[2]};                      // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void MosaicTileImage::set_data(ImageDataView<BGR24> const& view)
+{
+    auto const bytes_per_row = static_cast<size_t>(view.resolution().width()) * 3;
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto const* pixel = view.data() + row * bytes_per_row + x * 3; // NOLINT(*pointer-arithmetic)
+        return Rgb{pixel[2], pixel[1], pixel[0]};                      // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void MosaicTileImage::set_data(ImageDataView<RGBA32> const& view)
+{
+    auto const bytes_per_row = static_cast<size_t>(view.resolution().width()) * 4;
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto const* pixel = view.data() + row * bytes_per_row + x * 4; // NOLINT(*pointer-arithmetic)
+        return Rgb{pixel[0], pixel[1], pixel[2]};                      // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void MosaicTileImage::set_data(ImageDataView<GRAY8> const& view)
+{
+    auto const bytes_per_row = static_cast<size_t>(view.resolution().width());
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto const gray = view.data()[row * bytes_per_row + x]; // NOLINT(*pointer-arithmetic)
+        return Rgb{gray, gray, gray};
+    });
+}
+
+void MosaicTileImage::set_data(ImageDataView<GRAY16> const& view)
+{
+    auto const bytes_per_row = static_cast<size_t>(view.resolution().width()) * 2;
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto value = uint16_t{};
+        std::memcpy(&value, view.data() + row * bytes_per_row + x * 2, sizeof(value)); // NOLINT(*pointer-arithmetic) The data might not be aligned
+        auto const gray = static_cast<uint8_t>(value >> 8);
+        return Rgb{gray, gray, gray};
+    });
+}
+
+void MosaicTileImage::set_data(ImageDataView<YUYV> const& view)
+{
+    auto const bytes_per_row = static_cast<size_t>(view.resolution().width()) * 2;
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto const* pixels_pair = view.data() + row * bytes_per_row + (x & ~1u) * 2;             // NOLINT(*pointer-arithmetic) U and V are shared by each pair of pixels
+        return full_range_yuv_to_rgb(pixels_pair[(x & 1u) * 2], pixels_pair[1], pixels_pair[3]); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void MosaicTileImage::set_data(ImageDataView<NV12> const& view)
+{
+    auto const width = static_cast<size_t>(view.resolution().width());
+    set_data(ImagePlanesView<NV12>{{ImagePlane{view.data(), width}, ImagePlane{view.data() + view.resolution().pixels_count(), width}}, view.resolution(), view.row_order()}); // NOLINT(*pointer-arithmetic)
+}
+
+void MosaicTileImage::set_data(ImagePlanesView<NV12> const& view)
+{
+    auto const& luma   = view.plane(0);
+    auto const& chroma = view.plane(1);
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        auto const* uv = chroma.data + row / 2 * chroma.bytes_per_row + (x & ~1u);            // NOLINT(*pointer-arithmetic)
+        return video_range_yuv_to_rgb(luma.data[row * luma.bytes_per_row + x], uv[0], uv[1]); // NOLINT(*pointer-arithmetic)
+    });
+}
+
+void MosaicTileImage::set_data(ImagePlanesView<I420> const& view)
+{
+    auto const& luma = view.plane(0);
+    auto const& u    = view.plane(1);
+    auto const& v    = view.plane(2);
+    _state->write_tile(_tile_index, view.resolution(), view.row_order(), [&](uint32_t row, uint32_t x) {
+        return video_range_yuv_to_rgb(
+            luma.data[row * luma.bytes_per_row + x],   // NOLINT(*pointer-arithmetic)
+            u.data[row / 2 * u.bytes_per_row + x / 2], // NOLINT(*pointer-arithmetic)
+            v.data[row / 2 * v.bytes_per_row + x / 2]  // NOLINT(*pointer-arithmetic)
+        );
+    });
+}
+
+} // namespace wcam::internal
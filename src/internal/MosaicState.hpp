@@ -0,0 +1,118 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../Mosaic.hpp"
+#include "Subscriptions.hpp"
+
+namespace wcam::internal {
+
+using Rgb = std::array<uint8_t, 3>;
+
+class MosaicState {
+public:
+    explicit MosaicState(MosaicLayout layout);
+
+    /// Called on the capture thread of the camera, while it decodes a frame.
+    /// `read_pixel(row, x)` returns the color of a pixel of the frame, `row` being the index of the row in memory.
+    template<typename ReadPixelT>
+    void write_tile(size_t tile_index, Resolution frame_resolution, FirstRowIs row_order, ReadPixelT const& read_pixel);
+    /// Called on the capture thread of the camera, once its frame has been written to its tile
+    void on_tile_updated(std::shared_ptr<Image const> const&);
+
+    [[nodiscard]] auto image() -> MaybeImage;
+    [[nodiscard]] auto layout() const -> MosaicLayout const& { return _layout; }
+
+    /// The subscribers are owned by the state, so that they stop being called once the Mosaic is destroyed
+    void keep_subscriber_alive(std::shared_ptr<CropSubscriber> subscriber) { _subscribers.push_back(std::move(subscriber)); }
+
+private:
+    struct Tile {
+        MosaicTile            region{};
+        Resolution            frame_resolution{};
+        std::vector<uint32_t> frame_columns{}; // For each column of the tile, the column of the frame that we sample. Only recomputed when the resolution of the camera changes.
+        uint64_t              version{0};      // Incremented each time the tile is written, so that image() only copies the tiles that changed
+        std::mutex            mutex{};         // Prevents image() from copying a tile that is being written
+    };
+
+    /// The images that we published so far read from these buffers, so we can only write again in a buffer once no image uses it anymore
+    struct PublishedBuffer {
+        std::shared_ptr<uint8_t[]> data{};           // NOLINT(*c-arrays)
+        std::vector<uint64_t>      tiles_versions{}; // The version of each tile that the buffer contains
+    };
+
+    [[nodiscard]] auto buffer_to_publish() -> PublishedBuffer&;
+
+    [[nodiscard]] auto canvas_pixel(uint32_t x, uint32_t y) -> uint8_t* { return _canvas.data() + (static_cast<size_t>(y) * _layout.resolution.width() + x) * 3; } // NOLINT(*pointer-arithmetic)
+
+private:
+    MosaicLayout         _layout;
+    std::vector<Tile>    _tiles;
+    std::vector<uint8_t> _canvas; // RGB24, top row first. Only written by the cameras, each in its own tile.
+
+    std::atomic<uint64_t>          _version{0}; // Incremented each time a tile is updated
+    uint64_t                       _published_version{0};
+    MaybeImage                     _published_image{ImageNotInitYet{}};
+    std::array<PublishedBuffer, 2> _published_buffers{}; // Double-buffered, so that we can write in one while the latest image still reads from the other
+    PublishedBuffer const*         _latest_published_buffer{nullptr};
+    FrameMetadata                  _latest_metadata{};
+    std::mutex                     _image_mutex{};
+
+    std::vector<std::shared_ptr<CropSubscriber>> _subscribers{};
+};
+
+template<typename ReadPixelT>
+void MosaicState::write_tile(size_t tile_index, Resolution frame_resolution, FirstRowIs row_order, ReadPixelT const& read_pixel)
+{
+    auto&            tile = _tiles[tile_index];
+    std::scoped_lock lock{tile.mutex};
+    tile.version++;
+    if (tile.frame_resolution != frame_resolution)
+    {
+        tile.frame_resolution = frame_resolution;
+        tile.frame_columns.resize(tile.region.width);
+        for (uint32_t x = 0; x < tile.region.width; ++x)
+            tile.frame_columns[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * frame_resolution.width() / tile.region.width);
+    }
+    for (uint32_t y = 0; y < tile.region.height; ++y)
+    {
+        auto const  frame_row = static_cast<uint32_t>(static_cast<uint64_t>(y) * frame_resolution.height() / tile.region.height);
+        auto const  row       = row_order == FirstRowIs::Top ? frame_row : frame_resolution.height() - 1 - frame_row;
+        auto* const pixels    = canvas_pixel(tile.region.x, tile.region.y + y);
+        for (uint32_t x = 0; x < tile.region.width; ++x)
+        {
+            auto const color  = read_pixel(row, tile.frame_columns[x]);
+            pixels[x * 3 + 0] = color[0]; // NOLINT(*pointer-arithmetic)
+            pixels[x * 3 + 1] = color[1]; // NOLINT(*pointer-arithmetic)
+            pixels[x * 3 + 2] = color[2]; // NOLINT(*pointer-arithmetic)
+        }
+    }
+}
+
+/// The image that a camera fills when it is part of a Mosaic: instead of storing the frame, it scales it into the tile of the camera
+class MosaicTileImage : public Image {
+public:
+    MosaicTileImage(std::shared_ptr<MosaicState> state, size_t tile_index)
+        : _state{std::move(state)}
+        , _tile_index{tile_index}
+    {}
+
+    void set_data(ImageDataView<RGB24> const&) override;
+    void set_data(ImageDataView<BGR24> const&) override;
+    void set_data(ImageDataView<NV12> const&) override;
+    void set_data(ImageDataView<YUYV> const&) override;
+    void set_data(ImageDataView<RGBA32> const&) override;
+    void set_data(ImageDataView<GRAY8> const&) override;
+    void set_data(ImageDataView<GRAY16> const&) override;
+    void set_data(ImagePlanesView<NV12> const&) override;
+    void set_data(ImagePlanesView<I420> const&) override;
+
+private:
+    std::shared_ptr<MosaicState> _state;
+    size_t                       _tile_index;
+};
+
+} // namespace wcam::internal
@@ -0,0 +1,83 @@
+#include "MotionGate.hpp"
+#include <cstdlib>
+#include "DeviceSettingsManager.hpp"
+
+namespace wcam::internal {
+
+template<typename PixelFormatT>
+static auto rgb_luma_grid(ImageDataView<PixelFormatT> const& view, size_t red_offset, size_t blue_offset) -> LumaGrid
+{
+    auto const* data  = view.data();
+    auto const  width = view.resolution().width();
+    return LumaGrid{view.resolution(), [&](uint32_t x, uint32_t y) {
+                        auto const* pixel = data + (static_cast<size_t>(x) + static_cast<size_t>(y) * width) * 3;                 // NOLINT(*pointer-arithmetic)
+                        return static_cast<uint32_t>(pixel[red_offset] + 2 * pixel[1] + pixel[blue_offset]) / 4; // NOLINT(*pointer-arithmetic) Cheap approximation of the luminance
+                    }};
+}
+
+auto luma_grid(ImageDataView<RGB24> const& view) -> LumaGrid
+{
+    return rgb_luma_grid(view, 0, 2);
+}
+
+auto luma_grid(ImageDataView<BGR24> const& view) -> LumaGrid
+{
+    return rgb_luma_grid(view, 2, 0);
+}
+
+auto luma_grid(ImageDataView<NV12> const& view) -> LumaGrid
+{
+    auto const* y_plane = view.data(); // The Y plane is at the beginning of the data, with one byte per pixel
+    auto const  width   = view.resolution().width();
+    return LumaGrid{view.resolution(), [&](uint32_t x, uint32_t y) {
+                        return static_cast<uint32_t>(y_plane[static_cast<size_t>(x) + static_cast<size_t>(y) * width]); // NOLINT(*pointer-arithmetic)
+                    }};
+}
+
+auto luma_grid(ImageDataView<YUYV> const& view) -> LumaGrid
+{
+    auto const* data  = view.data(); // Each pixel uses 2 bytes, and its Y is the first one
+    auto const  width = view.resolution().width();
+    return LumaGrid{view.resolution(), [&](uint32_t x, uint32_t y) {
+                        return static_cast<uint32_t>(data[(static_cast<size_t>(x) + static_cast<size_t>(y) * width) * 2]); // NOLINT(*pointer-arithmetic)
+                    }};
+}
+
+auto luma_grid(ImagePlane const& luma, Resolution resolution) -> LumaGrid
+{
+    return LumaGrid{resolution, [&](uint32_t x, uint32_t y) {
+                        return static_cast<uint32_t>(luma.data[static_cast<size_t>(x) + static_cast<size_t>(y) * luma.bytes_per_row]); // NOLINT(*pointer-arithmetic)
+                    }};
+}
+
+auto MotionGate::is_enabled() -> bool
+{
+    _settings = device_settings<MotionGateSettings>().settings(_id);
+    if (!_settings.enabled)
+        _reference.reset(); // Make sure we don't compare with a very old frame once the gate is enabled again
+    return _settings.enabled;
+}
+
+auto MotionGate::filter(LumaGrid const& grid) -> std::optional<float>
+{
+    if (!_reference)
+    {
+        _reference = grid;
+        return 1.f; // Always publish the first frame
+    }
+
+    size_t changed_cells_count = 0;
+    for (size_t i = 0; i < grid.cells().size(); ++i)
+    {
+        if (std::abs(static_cast<int>(grid.cells()[i]) - static_cast<int>(_reference->cells()[i])) > _settings.luma_difference) // NOLINT(*constant-array-index)
+            changed_cells_count++;
+    }
+    auto const score = static_cast<float>(changed_cells_count) / static_cast<float>(grid.cells().size());
+    if (score < _settings.threshold)
+        return std::nullopt;
+
+    _reference = grid;
+    return score;
+}
+
+} // namespace wcam::internal
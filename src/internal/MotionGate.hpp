@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include "../DeviceId.hpp"
+#include "../Image.hpp"
+#include "../MotionGateSettings.hpp"
+
+namespace wcam::internal {
+
+/// A tiny version of the luminance of a frame, that is cheap to compute and to compare
+class LumaGrid {
+public:
+    static constexpr uint32_t width  = 64;
+    static constexpr uint32_t height = 48;
+
+    /// `luma_at(x, y)` must return the luminance of the pixel at (x, y) in the frame
+    template<typename LumaAt>
+    LumaGrid(Resolution resolution, LumaAt&& luma_at)
+    {
+        static constexpr uint32_t samples_per_side = 4; // We average 4x4 samples spread across each cell
+        for (uint32_t cell_y = 0; cell_y < height; ++cell_y)
+        {
+            for (uint32_t cell_x = 0; cell_x < width; ++cell_x)
+            {
+                uint32_t sum = 0;
+                for (uint32_t sample_y = 0; sample_y < samples_per_side; ++sample_y)
+                {
+                    for (uint32_t sample_x = 0; sample_x < samples_per_side; ++sample_x)
+                    {
+                        auto const x = static_cast<uint32_t>((static_cast<uint64_t>(cell_x * samples_per_side + sample_x) * resolution.width()) / (width * samples_per_side));
+                        auto const y = static_cast<uint32_t>((static_cast<uint64_t>(cell_y * samples_per_side + sample_y) * resolution.height()) / (height * samples_per_side));
+                        sum += luma_at(x, y);
+                    }
+                }
+                _cells[cell_x + cell_y * width] = static_cast<uint8_t>(sum / (samples_per_side * samples_per_side)); // NOLINT(*constant-array-index)
+            }
+        }
+    }
+
+    [[nodiscard]] auto cells() const -> std::array<uint8_t, width * height> const& { return _cells; }
+
+private:
+    std::array<uint8_t, width * height> _cells{};
+};
+
+auto luma_grid(ImageDataView<RGB24> const&) -> LumaGrid;
+auto luma_grid(ImageDataView<BGR24> const&) -> LumaGrid;
+auto luma_grid(ImageDataView<NV12> const&) -> LumaGrid;
+auto luma_grid(ImageDataView<YUYV> const&) -> LumaGrid;
+/// For the formats that start with a plane of luminance (e.g. NV12 and I420)
+auto luma_grid(ImagePlane const& luma, Resolution) -> LumaGrid;
+
+/// Drops the frames in which nothing moved. See MotionGateSettings for more details.
+class MotionGate {
+public:
+    explicit MotionGate(DeviceId id)
+        : _id{std::move(id)}
+    {}
+
+    /// Reads the latest settings. Call it once per frame, before the other functions.
+    [[nodiscard]] auto is_enabled() -> bool;
+    /// Returns the motion score if the frame should be published, or std::nullopt if it should be dropped because nothing moved.
+    [[nodiscard]] auto filter(LumaGrid const&) -> std::optional<float>;
+
+private:
+    DeviceId                _id;
+    MotionGateSettings      _settings{};
+    std::optional<LumaGrid> _reference{}; // The last frame that was published
+};
+
+} // namespace wcam::internal
@@ -0,0 +1,156 @@
+#include "Pipeline.hpp"
+#include <algorithm>
+#include <cassert>
+#include "BufferPool.hpp"
+#include "WorkStealingPool.hpp"
+
+namespace wcam {
+
+auto StageContext::result_of(StageId id) const -> PooledBuffer const&
+{
+    static auto const empty_buffer    = PooledBuffer{};
+    bool const        is_a_dependency = std::find(_dependencies.begin(), _dependencies.end(), id) != _dependencies.end();
+    assert(is_a_dependency && "You can only read the results of the stages that this stage depends on"); // Other stages might still be running
+    if (!is_a_dependency)
+        return empty_buffer;
+    return _results[id];
+}
+
+auto StageContext::make_buffer(size_t size) const -> PooledBuffer
+{
+    return internal::buffer_pool().acquire(size);
+}
+
+} // namespace wcam
+
+namespace wcam::internal {
+
+auto Pipeline::add_stage(std::string name, StageFunction function, std::vector<StageId> dependencies) -> StageId
+{
+    std::scoped_lock lock{_mutex};
+    auto const       id = _stages.size();
+    assert(std::all_of(dependencies.begin(), dependencies.end(), [&](StageId dependency) { return dependency < id; }) && "A stage can only depend on stages that have been added before it");
+    std::erase_if(dependencies, [&](StageId dependency) { return dependency >= id; });
+    auto stage          = std::make_shared<Stage>();
+    stage->name         = std::move(name);
+    stage->function     = std::move(function);
+    stage->dependencies = std::move(dependencies);
+    stage->metrics.name = stage->name;
+    _stages.push_back(std::move(stage));
+    return id;
+}
+
+auto Pipeline::is_empty() const -> bool
+{
+    std::scoped_lock lock{_mutex};
+    return _stages.empty();
+}
+
+void Pipeline::run(std::shared_ptr<Image const> const& image)
+{
+    auto stages = std::vector<std::shared_ptr<Stage>>{};
+    {
+        std::scoped_lock lock{_mutex};
+        stages = _stages; // Copy, so that stages can be added while we are running
+    }
+    if (stages.empty())
+        return;
+    if (_is_running.exchange(true))
+    {
+        _frames_skipped.fetch_add(1);
+        return;
+    }
+    std::make_shared<PipelineRun>(shared_from_this(), image, std::move(stages))->start();
+}
+
+auto Pipeline::metrics() const -> PipelineMetrics
+{
+    auto res = PipelineMetrics{.frames_skipped = _frames_skipped.load()};
+    std::scoped_lock lock{_mutex};
+    for (auto const& stage : _stages)
+    {
+        std::scoped_lock stage_lock{stage->mutex};
+        res.stages.push_back(stage->metrics);
+    }
+    return res;
+}
+
+auto Pipeline::result(StageId id) const -> PooledBuffer
+{
+    std::scoped_lock lock{_mutex};
+    if (id >= _stages.size())
+        return {};
+    std::scoped_lock stage_lock{_stages[id]->mutex};
+    return _stages[id]->last_result;
+}
+
+PipelineRun::PipelineRun(std::shared_ptr<Pipeline> pipeline, std::shared_ptr<Image const> image, std::vector<std::shared_ptr<Stage>> stages)
+    : _pipeline{std::move(pipeline)}
+    , _image{std::move(image)}
+    , _stages{std::move(stages)}
+    , _dependents(_stages.size())
+    , _results(_stages.size())
+    , _remaining_dependencies{std::make_unique<std::atomic<size_t>[]>(_stages.size())} // NOLINT(*c-arrays)
+    , _remaining_stages{_stages.size()}
+{
+    for (StageId id = 0; id < _stages.size(); ++id)
+    {
+        _remaining_dependencies[id].store(_stages[id]->dependencies.size());
+        for (StageId const dependency : _stages[id]->dependencies)
+            _dependents[dependency].push_back(id);
+    }
+}
+
+void PipelineRun::start()
+{
+    for (StageId id = 0; id < _stages.size(); ++id)
+    {
+        if (_stages[id]->dependencies.empty())
+            schedule(id);
+    }
+}
+
+void PipelineRun::schedule(StageId id)
+{
+    work_stealing_pool().submit([run = shared_from_this(), id]() {
+        run->execute(id);
+    });
+}
+
+void PipelineRun::execute(StageId id)
+{
+    auto&      stage   = *_stages[id];
+    auto const start   = std::chrono::steady_clock::now();
+    bool       success = true;
+    try
+    {
+        _results[id] = stage.function(StageContext{*_image, _results, stage.dependencies});
+    }
+    catch (...)
+    {
+        success = false;
+    }
+    auto const latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    {
+        std::scoped_lock lock{stage.mutex};
+        stage.metrics.frames_count++;
+        if (!success)
+            stage.metrics.failures_count++;
+        stage.total_latency += latency;
+        stage.metrics.last_latency    = latency;
+        stage.metrics.max_latency     = std::max(stage.metrics.max_latency, latency);
+        stage.metrics.average_latency = stage.total_latency / static_cast<int64_t>(stage.metrics.frames_count);
+        stage.last_result             = _results[id];
+    }
+
+    for (StageId const dependent : _dependents[id])
+    {
+        if (_remaining_dependencies[dependent].fetch_sub(1) == 1)
+            schedule(dependent);
+    }
+    if (_remaining_stages.fetch_sub(1) == 1)
+        _pipeline->_is_running.store(false);
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../PipelineStage.hpp"
+
+namespace wcam::internal {
+
+struct Stage {
+    std::string          name;
+    StageFunction        function;
+    std::vector<StageId> dependencies;
+
+    std::mutex               mutex{}; // Protects everything below
+    StageMetrics             metrics{};
+    std::chrono::nanoseconds total_latency{0};
+    PooledBuffer             last_result{};
+};
+
+/// The stages that a SharedWebcam wants to run on each new frame.
+/// Stages run on the work stealing pool, and a stage starts as soon as all its dependencies are done, so independent stages run in parallel.
+class Pipeline : public std::enable_shared_from_this<Pipeline> {
+public:
+    /// `dependencies` must only contain stages that have already been added, which guarantees that there is no cycle
+    auto               add_stage(std::string name, StageFunction, std::vector<StageId> dependencies) -> StageId;
+    [[nodiscard]] auto is_empty() const -> bool;
+
+    /// Starts processing the image in the background, unless the previous image is still being processed, in which case this one is skipped
+    void               run(std::shared_ptr<Image const> const&);
+    [[nodiscard]] auto metrics() const -> PipelineMetrics;
+    /// The output of the last frame that went through that stage
+    [[nodiscard]] auto result(StageId) const -> PooledBuffer;
+
+private:
+    friend class PipelineRun;
+    std::vector<std::shared_ptr<Stage>> _stages{};
+    mutable std::mutex                  _mutex{};
+    std::atomic<bool>                   _is_running{false};
+    std::atomic<uint64_t>               _frames_skipped{0};
+};
+
+/// The processing of one frame by all the stages of a pipeline
+class PipelineRun : public std::enable_shared_from_this<PipelineRun> {
+public:
+    PipelineRun(std::shared_ptr<Pipeline> pipeline, std::shared_ptr<Image const> image, std::vector<std::shared_ptr<Stage>> stages);
+
+    void start();
+
+private:
+    void schedule(StageId);
+    void execute(StageId);
+
+private:
+    std::shared_ptr<Pipeline>              _pipeline;
+    std::shared_ptr<Image const>           _image;
+    std::vector<std::shared_ptr<Stage>>    _stages;
+    std::vector<std::vector<StageId>>      _dependents;
+    std::vector<PooledBuffer>              _results;                // Each stage writes its own result, and only reads the ones of its dependencies, once they are done
+    std::unique_ptr<std::atomic<size_t>[]> _remaining_dependencies; // NOLINT(*c-arrays)
+    std::atomic<size_t>                    _remaining_stages;
+};
+
+} // namespace wcam::internal
@@ -0,0 +1,122 @@
+#include "SnapshotWriter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include "ThreadSettingsManager.hpp"
+#include "encode_jpeg.hpp"
+
+namespace wcam::internal {
+
+SnapshotWriter::SnapshotWriter()
+    : _thread{&SnapshotWriter::thread_job, std::ref(*this)}
+{}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    {
+        std::scoped_lock lock{_mutex};
+        _wants_to_stop = true;
+    }
+    _wake_up.notify_all();
+    _thread.join();
+}
+
+auto SnapshotWriter::push(std::function<std::future<MaybeBurst>()> const& request_frame, std::filesystem::path path, SnapshotCallback on_done, int jpeg_quality) -> bool
+{
+    {
+        std::scoped_lock lock{_mutex};
+        if (_jobs.size() >= max_pending_snapshots)
+            return false;
+        _jobs.push_back({request_frame(), std::move(path), std::move(on_done), jpeg_quality});
+    }
+    _wake_up.notify_one();
+    return true;
+}
+
+auto SnapshotWriter::wait_for_frame(Job& job) -> MaybeBurst
+{
+    while (job.frame.wait_for(std::chrono::milliseconds{100}) != std::future_status::ready)
+    {
+        std::scoped_lock lock{_mutex};
+        if (_wants_to_stop) // Don't prevent the application from exiting if the camera never gives us a frame
+            return Error_Unknown{"wcam was stopped before the snapshot could be taken"};
+    }
+    try
+    {
+        return job.frame.get();
+    }
+    catch (std::future_error const&)
+    {
+        return Error_Unknown{"The capture was stopped before the snapshot could be taken"};
+    }
+}
+
+/// MJPEG frames are already JPEG files, so we write them as is
+static auto write_jpeg(HistoryFrame const& frame, [[maybe_unused]] int jpeg_quality, std::FILE* file) -> std::optional<std::string>
+{
+    if (frame.format == HistoryFrameFormat::MJPEG)
+    {
+        if (std::fwrite(frame.data.get(), 1, frame.data_size, file) != frame.data_size)
+            return "Failed to write the file";
+        return std::nullopt;
+    }
+#if defined(__linux__)
+    return encode_jpeg(frame, jpeg_quality, file);
+#else
+    return "Snapshots can only be encoded on Linux for now"; // This is the only platform where we can get the raw frames anyways
+#endif
+}
+
+static auto save(MaybeBurst const& burst, std::filesystem::path const& path, int jpeg_quality) -> std::optional<CaptureError>
+{
+    auto const* frames = std::get_if<std::vector<BurstFrame>>(&burst);
+    if (!frames)
+        return std::get<CaptureError>(burst);
+    if (frames->empty())
+        return Error_Unknown{"The camera didn't give us any frame"};
+
+    auto* const file = std::fopen(path.string().c_str(), "wb"); // NOLINT(*owning-memory)
+    if (!file)
+        return Error_Unknown{"Failed to open \"" + path.string() + "\""};
+    auto error = write_jpeg(frames->front().frame, jpeg_quality, file);
+    if (std::fclose(file) != 0 && !error) // NOLINT(*owning-memory)
+        error = "Failed to write the file";
+    if (!error)
+        return std::nullopt;
+
+    auto ignored_error = std::error_code{};
+    std::filesystem::remove(path, ignored_error); // Don't leave a broken file behind
+    return Error_Unknown{*error + " (\"" + path.string() + "\")"};
+}
+
+void SnapshotWriter::thread_job(SnapshotWriter& self)
+{
+    while (true)
+    {
+        thread_settings_manager().apply_settings_if_they_changed(ThreadRole::Snapshot);
+        auto job = [&]() -> std::optional<Job> { // IIFE
+            std::unique_lock lock{self._mutex};
+            self._wake_up.wait(lock, [&]() { return !self._jobs.empty() || self._wants_to_stop; });
+            if (self._jobs.empty())
+                return std::nullopt;
+            auto job = std::move(self._jobs.front());
+            self._jobs.pop_front();
+            return job;
+        }();
+        if (!job)
+            return; // We have been asked to stop, and all the pending snapshots have been reported
+
+        auto const error = save(self.wait_for_frame(*job), job->path, job->jpeg_quality);
+        if (job->on_done)
+            job->on_done(error);
+    }
+}
+
+auto snapshot_writer() -> SnapshotWriter&
+{
+    static auto instance = SnapshotWriter{};
+    return instance;
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,52 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "../Burst.hpp"
+#include "../Snapshot.hpp"
+
+namespace wcam::internal {
+
+/// Writes the snapshots to disk on a background thread, one after the other, so that saving a frame never stalls the thread that asked for it
+class SnapshotWriter {
+public:
+    SnapshotWriter();
+    ~SnapshotWriter();
+    SnapshotWriter(SnapshotWriter const&)                        = delete;
+    auto operator=(SnapshotWriter const&) -> SnapshotWriter&     = delete;
+    SnapshotWriter(SnapshotWriter&&) noexcept                    = delete;
+    auto operator=(SnapshotWriter&&) noexcept -> SnapshotWriter& = delete;
+
+    /// `request_frame` is only called if there is room in the queue, otherwise we return false.
+    /// The frame is expected as a burst of a single frame.
+    [[nodiscard]] auto push(std::function<std::future<MaybeBurst>()> const& request_frame, std::filesystem::path path, SnapshotCallback on_done, int jpeg_quality) -> bool;
+
+private:
+    struct Job {
+        std::future<MaybeBurst> frame;
+        std::filesystem::path   path;
+        SnapshotCallback        on_done;
+        int                     jpeg_quality;
+    };
+
+    static void thread_job(SnapshotWriter&);
+    /// Waits for the frame, unless we are asked to stop in the meantime
+    [[nodiscard]] auto wait_for_frame(Job&) -> MaybeBurst;
+
+private:
+    std::deque<Job>         _jobs{};
+    bool                    _wants_to_stop{false};
+    std::mutex              _mutex{};
+    std::condition_variable _wake_up{};
+
+    std::thread _thread{}; // Must be initialized last, to make sure that everything else is init when the thread starts its job
+};
+
+/// Created the first time a snapshot is saved
+auto snapshot_writer() -> SnapshotWriter&;
+
+} // namespace wcam::internal
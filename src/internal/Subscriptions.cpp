@@ -0,0 +1,251 @@
+#include "Subscriptions.hpp"
+#include <algorithm>
+#include "ImageFactory.hpp"
+
+namespace wcam::internal {
+
+auto RateLimiter::should_deliver(float max_fps, std::chrono::steady_clock::time_point now) -> bool
+{
+    if (now < _next_delivery_time)
+        return false;
+    auto const interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>{1.f / max_fps});
+    _next_delivery_time = now - _next_delivery_time < interval
+                              ? _next_delivery_time + interval // Keep a regular cadence, even though frames don't arrive exactly when we would like them to
+                              : now + interval;                // We are way too late (e.g. the camera stopped sending frames for a while), restart the cadence from now
+    return true;
+}
+
+auto Subscription::max_fps() const -> std::optional<float>
+{
+    auto const max_fps = _max_fps.load();
+    if (max_fps <= 0.f)
+        return std::nullopt;
+    return max_fps;
+}
+
+void Subscription::set_max_fps(std::optional<float> max_fps)
+{
+    _max_fps.store(max_fps.value_or(0.f));
+}
+
+auto Subscription::paced(MaybeImage const& latest_image) -> MaybeImage
+{
+    if (!_pacer.settings().enabled)
+        return latest_image;
+    if (!std::holds_alternative<std::shared_ptr<Image const>>(latest_image))
+    {
+        _pacer.reset(); // Errors and restarts must be reported immediately, and the frames that we held belong to the previous capture
+        return latest_image;
+    }
+    if (auto image = _pacer.release(std::chrono::steady_clock::now()))
+        return image;
+    return latest_image; // No frame has been due since pacing was enabled
+}
+
+auto Subscription::filter(MaybeImage const& maybe_latest_image) -> MaybeImage
+{
+    auto const latest_image = paced(maybe_latest_image);
+    auto const max_fps      = this->max_fps();
+    if (!max_fps)
+        return latest_image;
+
+    std::scoped_lock lock{_mutex};
+    auto const*      latest = std::get_if<std::shared_ptr<Image const>>(&latest_image);
+    auto const*      last   = std::get_if<std::shared_ptr<Image const>>(&_last_delivered_image);
+    if (!latest) // Errors and restarts must be reported immediately
+    {
+        _last_delivered_image = latest_image;
+        return latest_image;
+    }
+    if (last && *last == *latest) // Not a new image
+        return latest_image;
+    bool const is_time_to_deliver = _rate_limiter.should_deliver(*max_fps, std::chrono::steady_clock::now());
+    if (last && !is_time_to_deliver)
+        return _last_delivered_image;
+    _last_delivered_image = latest_image;
+    return latest_image;
+}
+
+void Subscription::add_listener(std::shared_ptr<FrameListener> const& listener)
+{
+    std::scoped_lock lock{_mutex};
+    std::erase_if(_listeners, [](std::weak_ptr<FrameListener> const& weak_listener) {
+        return weak_listener.expired();
+    });
+    _listeners.push_back(listener);
+}
+
+void Subscription::on_new_image(std::shared_ptr<Image const> const& image)
+{
+    _pacer.push(image, std::chrono::steady_clock::now());
+
+    auto listeners = std::vector<std::shared_ptr<FrameListener>>{};
+    {
+        std::scoped_lock lock{_mutex};
+        for (auto const& weak_listener : _listeners)
+        {
+            if (auto listener = weak_listener.lock())
+                listeners.push_back(std::move(listener));
+        }
+    }
+    for (auto const& listener : listeners)
+        (*listener)(image);
+
+    if (_pipeline->is_empty())
+        return;
+    if (auto const max_fps = this->max_fps())
+    {
+        std::scoped_lock lock{_mutex};
+        if (!_pipeline_rate_limiter.should_deliver(*max_fps, std::chrono::steady_clock::now()))
+            return;
+    }
+    _pipeline->run(image);
+}
+
+void Subscription::set_slice_callback(SliceCallback callback, uint32_t rows_per_slice)
+{
+    bool const       wants_slices = static_cast<bool>(callback);
+    std::scoped_lock lock{_mutex};
+    _slice_callback = wants_slices ? std::make_shared<SliceCallback>(std::move(callback)) : nullptr;
+    _rows_per_slice.store(wants_slices ? std::max(rows_per_slice, 1u) : 0);
+}
+
+auto Subscription::rows_per_slice() const -> std::optional<uint32_t>
+{
+    auto const rows_per_slice = _rows_per_slice.load();
+    if (rows_per_slice == 0)
+        return std::nullopt;
+    return rows_per_slice;
+}
+
+void Subscription::on_new_slice(FrameSlice const& slice)
+{
+    auto const callback = [&]() { // IIFE
+        std::scoped_lock lock{_mutex};
+        return _slice_callback;
+    }();
+    if (callback)
+        (*callback)(slice);
+}
+
+auto Subscriptions::add() -> std::shared_ptr<Subscription>
+{
+    auto             subscription = std::make_shared<Subscription>();
+    std::scoped_lock lock{_mutex};
+    std::erase_if(_subscriptions, [](std::weak_ptr<Subscription> const& subscription) {
+        return subscription.expired();
+    });
+    _subscriptions.push_back(subscription);
+    return subscription;
+}
+
+auto Subscriptions::max_fps() const -> std::optional<float>
+{
+    std::scoped_lock lock{_mutex};
+    auto             max_fps = std::optional<float>{};
+    for (auto const& weak_subscription : _subscriptions)
+    {
+        auto const subscription = weak_subscription.lock();
+        if (!subscription)
+            continue;
+        auto const subscription_max_fps = subscription->max_fps();
+        if (!subscription_max_fps)
+            return std::nullopt;
+        max_fps = std::max(max_fps.value_or(0.f), *subscription_max_fps);
+    }
+    return max_fps;
+}
+
+void Subscriptions::on_new_image(std::shared_ptr<Image const> const& image) const
+{
+    auto subscriptions = std::vector<std::shared_ptr<Subscription>>{};
+    {
+        std::scoped_lock lock{_mutex};
+        for (auto const& weak_subscription : _subscriptions)
+        {
+            if (auto subscription = weak_subscription.lock())
+                subscriptions.push_back(std::move(subscription));
+        }
+    }
+    for (auto const& subscription : subscriptions) // Outside of the lock, so that a slow pipeline doesn't block open_webcam()
+        subscription->on_new_image(image);
+}
+
+auto Subscriptions::rows_per_slice() const -> std::optional<uint32_t>
+{
+    std::scoped_lock lock{_mutex};
+    auto             rows_per_slice = std::optional<uint32_t>{};
+    for (auto const& weak_subscription : _subscriptions)
+    {
+        auto const subscription = weak_subscription.lock();
+        if (!subscription)
+            continue;
+        if (auto const subscription_rows_per_slice = subscription->rows_per_slice())
+            rows_per_slice = std::min(rows_per_slice.value_or(*subscription_rows_per_slice), *subscription_rows_per_slice);
+    }
+    return rows_per_slice;
+}
+
+void Subscriptions::on_new_slice(FrameSlice const& slice) const
+{
+    auto subscriptions = std::vector<std::shared_ptr<Subscription>>{};
+    {
+        std::scoped_lock lock{_mutex};
+        for (auto const& weak_subscription : _subscriptions)
+        {
+            if (auto subscription = weak_subscription.lock())
+                subscriptions.push_back(std::move(subscription));
+        }
+    }
+    for (auto const& subscription : subscriptions)
+        subscription->on_new_slice(slice);
+}
+
+void Subscriptions::add_crop_subscriber(std::shared_ptr<CropSubscriber> const& subscriber)
+{
+    std::scoped_lock lock{_mutex};
+    std::erase_if(_crop_subscribers, [](std::weak_ptr<CropSubscriber> const& weak_subscriber) {
+        return weak_subscriber.expired();
+    });
+    _crop_subscribers.push_back(subscriber);
+}
+
+auto Subscriptions::crop_subscribers() const -> std::vector<std::shared_ptr<CropSubscriber>>
+{
+    auto subscribers = std::vector<std::shared_ptr<CropSubscriber>>{};
+
+    std::scoped_lock lock{_mutex};
+    for (auto const& weak_subscriber : _crop_subscribers)
+    {
+        if (auto subscriber = weak_subscriber.lock())
+            subscribers.push_back(std::move(subscriber));
+    }
+    return subscribers;
+}
+
+auto CropSubscriber::make_image() const -> std::shared_ptr<Image>
+{
+    return _make_image ? _make_image() : image_factory().make_image();
+}
+
+auto CropSubscriber::wants_frame() -> bool
+{
+    std::scoped_lock lock{_mutex};
+    return _wants_frame && _wants_frame();
+}
+
+void CropSubscriber::on_new_image(MaybeImage image)
+{
+    std::scoped_lock lock{_mutex};
+    if (_on_new_image)
+        _on_new_image(std::move(image));
+}
+
+void CropSubscriber::disconnect()
+{
+    std::scoped_lock lock{_mutex};
+    _wants_frame  = nullptr;
+    _on_new_image = nullptr;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
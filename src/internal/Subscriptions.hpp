@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "../FrameSlice.hpp"
+#include "../MaybeImage.hpp"
+#include "../VirtualWebcam.hpp"
+#include "FramePacer.hpp"
+#include "Pipeline.hpp"
+
+namespace wcam::internal {
+
+/// Helps deliver frames at a given maximum rate, while keeping the cadence regular
+class RateLimiter {
+public:
+    /// Returns true iff a frame arriving now should be delivered
+    [[nodiscard]] auto should_deliver(float max_fps, std::chrono::steady_clock::time_point now) -> bool;
+
+private:
+    std::chrono::steady_clock::time_point _next_delivery_time{};
+};
+
+/// Called on the capture thread for each new image, so it must be cheap
+using FrameListener = std::function<void(std::shared_ptr<Image const> const&)>;
+
+/// A virtual camera that shows a region of the images of another camera (see add_virtual_webcam()), or a tile of a Mosaic
+class CropSubscriber {
+public:
+    /// `make_image` creates the image that receives the region. When empty, we use the image type given to set_image_type().
+    CropSubscriber(CropRegion region, std::function<bool()> wants_frame, std::function<void(MaybeImage)> on_new_image, std::function<std::shared_ptr<Image>()> make_image = {})
+        : _region{region}
+        , _wants_frame{std::move(wants_frame)}
+        , _on_new_image{std::move(on_new_image)}
+        , _make_image{std::move(make_image)}
+    {}
+
+    [[nodiscard]] auto region() const -> CropRegion { return _region; }
+    [[nodiscard]] auto make_image() const -> std::shared_ptr<Image>;
+    /// Called on the capture thread of the physical camera, before it starts decoding a frame. Returns false once disconnected.
+    [[nodiscard]] auto wants_frame() -> bool;
+    /// Called on the capture thread of the physical camera. Does nothing once disconnected.
+    void               on_new_image(MaybeImage);
+    /// Waits until the callbacks are done, and makes sure that they will never be called again
+    void               disconnect();
+
+private:
+    CropRegion                              _region;
+    std::function<bool()>                   _wants_frame;
+    std::function<void(MaybeImage)>         _on_new_image;
+    std::function<std::shared_ptr<Image>()> _make_image;
+    std::mutex                              _mutex{};
+};
+
+/// Created by each call to open_webcam(). Copies of a SharedWebcam share the same Subscription.
+class Subscription {
+public:
+    [[nodiscard]] auto max_fps() const -> std::optional<float>;
+    void               set_max_fps(std::optional<float>);
+
+    /// Returns the image that this subscriber should see, given its pacing and its max fps
+    [[nodiscard]] auto filter(MaybeImage const& latest_image) -> MaybeImage;
+
+    [[nodiscard]] auto pacer() -> FramePacer& { return _pacer; }
+
+    [[nodiscard]] auto pipeline() -> Pipeline& { return *_pipeline; }
+    /// The listener is called for every new image, regardless of our max fps. We only keep a weak reference: the listener stops being called once you destroy it.
+    void               add_listener(std::shared_ptr<FrameListener> const&);
+    /// Called by the capture thread each time a new image is published. Calls the listeners, and runs the stages of the pipeline (at most at our max fps).
+    void               on_new_image(std::shared_ptr<Image const> const&);
+
+    /// Use an empty callback to stop receiving the slices
+    void               set_slice_callback(SliceCallback, uint32_t rows_per_slice);
+    /// std::nullopt if we don't want to receive the frames in slices
+    [[nodiscard]] auto rows_per_slice() const -> std::optional<uint32_t>;
+    void               on_new_slice(FrameSlice const&);
+
+private:
+    [[nodiscard]] auto paced(MaybeImage const& latest_image) -> MaybeImage;
+
+private:
+    std::atomic<float>    _max_fps{0.f};      // 0 means that there is no cap
+    std::atomic<uint32_t> _rows_per_slice{0}; // 0 means that we don't want slices
+
+    MaybeImage  _last_delivered_image{ImageNotInitYet{}};
+    RateLimiter _rate_limiter{};
+    FramePacer  _pacer{};
+    std::mutex  _mutex{};
+
+    std::shared_ptr<Pipeline> _pipeline{std::make_shared<Pipeline>()}; // Shared with the runs that are in flight, because they might finish after the subscription is destroyed
+    RateLimiter               _pipeline_rate_limiter{};
+
+    std::vector<std::weak_ptr<FrameListener>> _listeners{};
+    std::shared_ptr<SliceCallback>            _slice_callback{}; // Shared so that we can call it outside of the lock, even if it is replaced in the meantime
+};
+
+/// All the subscriptions to a given camera.
+/// Shared between the WebcamRequest and its Capture, so that the capture thread knows what its consumers want.
+class Subscriptions {
+public:
+    [[nodiscard]] auto add() -> std::shared_ptr<Subscription>;
+
+    /// The highest cap of all the subscribers, or std::nullopt if at least one of them wants all the frames.
+    /// This is the rate at which we decode frames. Each subscription then applies its own cap in filter(), which can only be approximate when it is not a divisor of this one.
+    [[nodiscard]] auto max_fps() const -> std::optional<float>;
+
+    /// Forwards the image to all the subscriptions
+    void on_new_image(std::shared_ptr<Image const> const&) const;
+
+    /// The smallest slice height that one of the subscribers asked for, or std::nullopt if none of them wants slices
+    [[nodiscard]] auto rows_per_slice() const -> std::optional<uint32_t>;
+    /// Forwards the slice to all the subscriptions that want slices
+    void               on_new_slice(FrameSlice const&) const;
+
+    /// We only keep a weak reference: the virtual camera stops receiving images once you destroy the subscriber
+    void               add_crop_subscriber(std::shared_ptr<CropSubscriber> const&);
+    [[nodiscard]] auto crop_subscribers() const -> std::vector<std::shared_ptr<CropSubscriber>>;
+
+private:
+    std::vector<std::weak_ptr<Subscription>>   _subscriptions{};
+    std::vector<std::weak_ptr<CropSubscriber>> _crop_subscribers{};
+    mutable std::mutex                         _mutex{};
+};
+
+} // namespace wcam::internal
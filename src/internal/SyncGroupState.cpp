@@ -0,0 +1,80 @@
+#include "SyncGroupState.hpp"
+#include <algorithm>
+
+namespace wcam::internal {
+
+SyncGroupState::SyncGroupState(size_t cameras_count, std::chrono::nanoseconds tolerance, size_t history_size)
+    : _histories(cameras_count)
+    , _tolerance{tolerance}
+    , _history_size{std::max<size_t>(history_size, 1)}
+{
+}
+
+static auto timestamp(std::shared_ptr<Image const> const& image) -> std::chrono::steady_clock::time_point
+{
+    return image->metadata().device_timestamp.value_or(image->metadata().timestamp); // The hardware timestamps are more precise, when we have them
+}
+
+static auto distance(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) -> std::chrono::nanoseconds
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(a < b ? b - a : a - b);
+}
+
+void SyncGroupState::on_new_image(size_t camera_index, std::shared_ptr<Image const> const& image)
+{
+    std::scoped_lock lock{_mutex};
+    auto&            history = _histories[camera_index];
+    history.push_back(image);
+    if (history.size() > _history_size)
+        history.pop_front();
+
+    // Look for the frames of the other cameras that are the closest to this new one
+    auto const anchor = timestamp(image);
+    auto       oldest = anchor;
+    auto       newest = anchor;
+    auto       images = std::vector<std::shared_ptr<Image const>>(_histories.size());
+
+    images[camera_index] = image;
+    for (size_t i = 0; i < _histories.size(); ++i)
+    {
+        if (i == camera_index)
+            continue;
+        auto const closest = std::min_element(_histories[i].begin(), _histories[i].end(), [&](auto const& a, auto const& b) {
+            return distance(timestamp(a), anchor) < distance(timestamp(b), anchor);
+        });
+        if (closest == _histories[i].end() || distance(timestamp(*closest), anchor) > _tolerance)
+            return; // The matching frame of that camera hasn't arrived yet (or has been dropped), we will try again when it arrives
+        images[i] = *closest;
+        oldest    = std::min(oldest, timestamp(*closest));
+        newest    = std::max(newest, timestamp(*closest));
+    }
+
+    auto const skew = std::chrono::duration_cast<std::chrono::nanoseconds>(newest - oldest);
+    if (skew > _tolerance || !is_newer_than_latest_set(images))
+        return;
+    _latest_set = FrameSet{
+        .images = std::move(images),
+        .skew   = skew,
+        .index  = ++_sets_count,
+    };
+}
+
+auto SyncGroupState::is_newer_than_latest_set(std::vector<std::shared_ptr<Image const>> const& images) const -> bool
+{
+    if (!_latest_set)
+        return true;
+    for (size_t i = 0; i < images.size(); ++i) // Makes sure that a frame is never used in two different sets
+    {
+        if (timestamp(images[i]) <= timestamp(_latest_set->images[i]))
+            return false;
+    }
+    return true;
+}
+
+auto SyncGroupState::frame_set() const -> std::optional<FrameSet>
+{
+    std::scoped_lock lock{_mutex};
+    return _latest_set;
+}
+
+} // namespace wcam::internal
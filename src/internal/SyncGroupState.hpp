@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "../SyncGroup.hpp"
+#include "Subscriptions.hpp"
+
+namespace wcam::internal {
+
+class SyncGroupState {
+public:
+    SyncGroupState(size_t cameras_count, std::chrono::nanoseconds tolerance, size_t history_size);
+
+    /// Called on the capture thread of the camera
+    void               on_new_image(size_t camera_index, std::shared_ptr<Image const> const&);
+    [[nodiscard]] auto frame_set() const -> std::optional<FrameSet>;
+
+    /// The listeners are owned by the state, so that they stop being called once the SyncGroup is destroyed
+    void keep_listener_alive(std::shared_ptr<FrameListener> listener) { _listeners.push_back(std::move(listener)); }
+
+private:
+    [[nodiscard]] auto is_newer_than_latest_set(std::vector<std::shared_ptr<Image const>> const&) const -> bool;
+
+private:
+    std::vector<std::deque<std::shared_ptr<Image const>>> _histories;
+    std::chrono::nanoseconds                              _tolerance;
+    size_t                                                _history_size;
+    std::optional<FrameSet>                               _latest_set{};
+    uint64_t                                              _sets_count{0};
+    mutable std::mutex                                    _mutex{};
+
+    std::vector<std::shared_ptr<FrameListener>> _listeners{};
+};
+
+} // namespace wcam::internal
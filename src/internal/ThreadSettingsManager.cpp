@@ -0,0 +1,51 @@
+#include "ThreadSettingsManager.hpp"
+
+namespace wcam::internal {
+
+static auto index(ThreadRole role) -> size_t
+{
+    return static_cast<size_t>(role);
+}
+
+static auto default_name(ThreadRole role) -> char const*
+{
+    switch (role)
+    {
+    case ThreadRole::Manager:
+        return "wcam Manager";
+    case ThreadRole::Capture:
+        return "wcam Capture";
+    case ThreadRole::Pipeline:
+        return "wcam Pipeline";
+    case ThreadRole::Snapshot:
+        return "wcam Snapshot";
+    }
+    return "wcam";
+}
+
+auto ThreadSettingsManager::settings(ThreadRole role) const -> ThreadSettings
+{
+    std::scoped_lock lock{_mutex};
+    return _settings[index(role)]; // NOLINT(*constant-array-index)
+}
+
+void ThreadSettingsManager::set_settings(ThreadRole role, ThreadSettings settings)
+{
+    {
+        std::scoped_lock lock{_mutex};
+        _settings[index(role)] = std::move(settings); // NOLINT(*constant-array-index)
+    }
+    _generation.fetch_add(1);
+}
+
+void ThreadSettingsManager::apply_settings_if_they_changed(ThreadRole role)
+{
+    thread_local uint64_t applied_generation{0}; // Each thread only has one role, so we don't need to store one generation per role
+    auto const            generation = _generation.load();
+    if (generation == applied_generation)
+        return;
+    applied_generation = generation;
+    apply_thread_settings(settings(role), default_name(role));
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "../ThreadSettings.hpp"
+
+namespace wcam::internal {
+
+class ThreadSettingsManager {
+public:
+    [[nodiscard]] auto settings(ThreadRole) const -> ThreadSettings;
+    void               set_settings(ThreadRole, ThreadSettings);
+
+    /// Must be called regularly by each of our threads, from the thread itself. Cheap when the settings haven't changed since the last call.
+    void apply_settings_if_they_changed(ThreadRole);
+
+private:
+    std::array<ThreadSettings, 4> _settings{};
+    mutable std::mutex            _mutex{};
+    std::atomic<uint64_t>         _generation{1}; // Starts at 1 so that each thread applies the settings (and especially its name) on its first call
+};
+
+inline auto thread_settings_manager() -> ThreadSettingsManager& // Not part of the Manager, for the same reasons as the ResolutionsManager: we want to remember the settings even when the library is not alive
+{
+    static auto instance = ThreadSettingsManager{};
+    return instance;
+}
+
+/// Applies the settings to the calling thread. Implemented for each platform.
+void apply_thread_settings(ThreadSettings const&, char const* default_name);
+
+} // namespace wcam::internal
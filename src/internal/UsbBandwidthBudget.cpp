@@ -0,0 +1,67 @@
+#include "UsbBandwidthBudget.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace wcam::internal {
+
+UsbBandwidthReservation::~UsbBandwidthReservation()
+{
+    release();
+}
+
+UsbBandwidthReservation::UsbBandwidthReservation(UsbBandwidthReservation&& other) noexcept
+    : _bus_id{std::move(other._bus_id)}
+    , _bytes_per_second{std::exchange(other._bytes_per_second, 0)}
+{
+}
+
+auto UsbBandwidthReservation::operator=(UsbBandwidthReservation&& other) noexcept -> UsbBandwidthReservation&
+{
+    if (this != &other)
+    {
+        release();
+        _bus_id           = std::move(other._bus_id);
+        _bytes_per_second = std::exchange(other._bytes_per_second, 0);
+    }
+    return *this;
+}
+
+void UsbBandwidthReservation::release()
+{
+    if (_bytes_per_second == 0)
+        return;
+    usb_bandwidth_budget().release(_bus_id, _bytes_per_second);
+    _bytes_per_second = 0;
+}
+
+auto UsbBandwidthBudget::available_bandwidth(std::string const& bus_id, uint64_t bus_capacity) const -> uint64_t
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _reserved_bandwidths.find(bus_id);
+    if (it == _reserved_bandwidths.end())
+        return bus_capacity;
+    return it->second < bus_capacity ? bus_capacity - it->second : 0;
+}
+
+auto UsbBandwidthBudget::reserve(std::string const& bus_id, uint64_t bytes_per_second) -> UsbBandwidthReservation
+{
+    std::scoped_lock lock{_mutex};
+    _reserved_bandwidths[bus_id] += bytes_per_second;
+    return UsbBandwidthReservation{bus_id, bytes_per_second};
+}
+
+void UsbBandwidthBudget::release(std::string const& bus_id, uint64_t bytes_per_second)
+{
+    {
+        std::scoped_lock lock{_mutex};
+        auto const       it = _reserved_bandwidths.find(bus_id);
+        if (it == _reserved_bandwidths.end())
+            return;
+        it->second -= std::min(it->second, bytes_per_second);
+        if (it->second == 0)
+            _reserved_bandwidths.erase(it);
+    }
+    _generation.fetch_add(1);
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace wcam::internal {
+
+class UsbBandwidthBudget;
+
+/// Gives back the bandwidth to the budget when destroyed
+class UsbBandwidthReservation {
+public:
+    UsbBandwidthReservation() = default;
+    ~UsbBandwidthReservation();
+    UsbBandwidthReservation(UsbBandwidthReservation const&)                    = delete;
+    auto operator=(UsbBandwidthReservation const&) -> UsbBandwidthReservation& = delete;
+    UsbBandwidthReservation(UsbBandwidthReservation&&) noexcept;
+    auto operator=(UsbBandwidthReservation&&) noexcept -> UsbBandwidthReservation&;
+
+private:
+    friend class UsbBandwidthBudget;
+    UsbBandwidthReservation(std::string bus_id, uint64_t bytes_per_second)
+        : _bus_id{std::move(bus_id)}
+        , _bytes_per_second{bytes_per_second}
+    {}
+
+    void release();
+
+private:
+    std::string _bus_id{};
+    uint64_t    _bytes_per_second{0};
+};
+
+/// Keeps track of the bandwidth used by each of our captures, per USB bus.
+/// Cameras plugged on the same USB controller share its isochronous bandwidth, and when it is exhausted the driver refuses to start the stream.
+/// This allows us to pick a mode that fits in what is left, and to report a clear error when nothing fits.
+class UsbBandwidthBudget {
+public:
+    /// `bus_capacity` is the total bandwidth (in bytes per second) that can be used by isochronous transfers on that bus
+    [[nodiscard]] auto available_bandwidth(std::string const& bus_id, uint64_t bus_capacity) const -> uint64_t;
+    [[nodiscard]] auto reserve(std::string const& bus_id, uint64_t bytes_per_second) -> UsbBandwidthReservation;
+
+    /// Incremented each time some bandwidth is given back. Allows us to know when it is worth retrying to start a capture that didn't fit.
+    [[nodiscard]] auto generation() const -> uint64_t { return _generation.load(); }
+
+private:
+    friend class UsbBandwidthReservation;
+    void release(std::string const& bus_id, uint64_t bytes_per_second);
+
+private:
+    std::unordered_map<std::string, uint64_t> _reserved_bandwidths{};
+    mutable std::mutex                        _mutex{};
+    std::atomic<uint64_t>                     _generation{0};
+};
+
+inline auto usb_bandwidth_budget() -> UsbBandwidthBudget&
+{
+    static auto instance = UsbBandwidthBudget{};
+    return instance;
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,223 @@
+#if defined(__linux__)
+#include "UvcMetadataStream.hpp"
+#include <fcntl.h>
+#include <linux/usb/video.h>
+#include <linux/uvcvideo.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+
+namespace wcam::internal {
+
+/// The metadata node is another child of the same USB interface as the video node
+static auto find_metadata_node(std::filesystem::path const& video_node_path) -> std::optional<std::filesystem::path>
+{
+    try
+    {
+        auto const video_node = std::filesystem::canonical(video_node_path).filename(); // e.g. "video0"
+        auto const sysfs      = std::filesystem::path{"/sys/class/video4linux"};
+        auto const interface  = std::filesystem::canonical(sysfs / video_node / "device");
+        for (auto const& entry : std::filesystem::directory_iterator(sysfs))
+        {
+            if (entry.path().filename() == video_node
+                || std::filesystem::canonical(entry.path() / "device") != interface)
+            {
+                continue;
+            }
+            auto const node_path = std::filesystem::path{"/dev"} / entry.path().filename();
+            auto const handle    = FileRAII{open(node_path.c_str(), O_RDONLY)};
+            auto       cap       = v4l2_capability{};
+            if (handle != -1
+                && ioctl(handle, VIDIOC_QUERYCAP, &cap) == 0
+                && (cap.device_caps & V4L2_CAP_META_CAPTURE))
+            {
+                return node_path;
+            }
+        }
+    }
+    catch (std::exception const&)
+    {
+    }
+    return std::nullopt;
+}
+
+auto UvcMetadataStream::open(std::filesystem::path const& video_node_path) -> std::unique_ptr<UvcMetadataStream>
+{
+    auto const node_path = find_metadata_node(video_node_path);
+    if (!node_path)
+        return nullptr;
+    int const handle = ::open(node_path->c_str(), O_RDWR | O_NONBLOCK); // Non-blocking, because the metadata must never delay the frames
+    if (handle == -1)
+        return nullptr;
+    auto stream = std::make_unique<UvcMetadataStream>(handle);
+    if (!stream->start())
+        return nullptr;
+    return stream;
+}
+
+auto UvcMetadataStream::start() -> bool
+{
+    auto format = v4l2_format{};
+    format.type = V4L2_BUF_TYPE_META_CAPTURE;
+    if (ioctl(_handle, VIDIOC_G_FMT, &format) == -1 || format.fmt.meta.dataformat != V4L2_META_FMT_UVC)
+        return false;
+
+    auto req   = v4l2_requestbuffers{};
+    req.count  = static_cast<unsigned int>(_buffers.size());
+    req.type   = V4L2_BUF_TYPE_META_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (ioctl(_handle, VIDIOC_REQBUFS, &req) == -1)
+        return false;
+    if (req.count < _buffers.size())
+    {
+        release_buffers();
+        return false;
+    }
+
+    for (size_t i = 0; i < _buffers.size(); ++i)
+    {
+        auto buf   = v4l2_buffer{};
+        buf.type   = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = static_cast<unsigned int>(i);
+        if (ioctl(_handle, VIDIOC_QUERYBUF, &buf) == -1)
+        {
+            release_buffers();
+            return false;
+        }
+        auto& plane              = _buffers[i].planes[0]; // NOLINT(*constant-array-index)
+        _buffers[i].planes_count = 1;                     // NOLINT(*constant-array-index)
+        plane.size               = buf.length;
+        plane.ptr                = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, _handle, buf.m.offset);
+        if (plane.ptr == MAP_FAILED
+            || ioctl(_handle, VIDIOC_QBUF, &buf) == -1)
+        {
+            release_buffers();
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_META_CAPTURE;
+    _is_streaming      = ioctl(_handle, VIDIOC_STREAMON, &type) == 0;
+    if (!_is_streaming)
+        release_buffers();
+    return _is_streaming;
+}
+
+void UvcMetadataStream::release_buffers()
+{
+    for (auto& buffer : _buffers)
+        buffer.unmap();
+
+    auto req    = v4l2_requestbuffers{};
+    req.count   = 0;
+    req.type    = V4L2_BUF_TYPE_META_CAPTURE;
+    req.memory  = V4L2_MEMORY_MMAP;
+    std::ignore = ioctl(_handle, VIDIOC_REQBUFS, &req);
+}
+
+UvcMetadataStream::~UvcMetadataStream()
+{
+    if (_is_streaming)
+    {
+        v4l2_buf_type type = V4L2_BUF_TYPE_META_CAPTURE;
+        ioctl(_handle, VIDIOC_STREAMOFF, &type);
+    }
+    release_buffers();
+}
+
+static auto read_u32_little_endian(uint8_t const* data) -> uint32_t
+{
+    return static_cast<uint32_t>(data[0])               // NOLINT(*pointer-arithmetic)
+           | (static_cast<uint32_t>(data[1]) << 8)      // NOLINT(*pointer-arithmetic)
+           | (static_cast<uint32_t>(data[2]) << 16)     // NOLINT(*pointer-arithmetic)
+           | (static_cast<uint32_t>(data[3]) << 24);    // NOLINT(*pointer-arithmetic)
+}
+
+struct ParsedMetadata {
+    std::optional<uint32_t> presentation_time{}; // PTS: the camera time at which the capture of the frame started
+    struct ClockSample {
+        uint32_t                              device_time; // STC: the camera time at which the payload was sent
+        std::chrono::steady_clock::time_point host_time;   // The time at which the driver received that payload
+    };
+    std::optional<ClockSample> clock_sample{};
+};
+
+/// A metadata buffer contains one uvc_meta_buf for each USB payload of the frame. Each one is followed by the optional fields of the UVC payload header: PTS (4 bytes), and then SCR (6 bytes).
+static auto parse_metadata(uint8_t const* data, size_t size) -> ParsedMetadata
+{
+    static constexpr size_t header_size = offsetof(uvc_meta_buf, buf);
+    static constexpr size_t pts_size    = 4;
+    static constexpr size_t scr_size    = 6;
+
+    auto   res    = ParsedMetadata{};
+    size_t offset = 0;
+    while (offset + header_size <= size)
+    {
+        auto header = uvc_meta_buf{};
+        std::memcpy(&header, data + offset, header_size); // NOLINT(*pointer-arithmetic) The data is not aligned
+        if (header.length < 2)                            // The length includes the two bytes of length and flags
+            break;
+        size_t const fields_size = header.length - 2u;
+        if (offset + header_size + fields_size > size)
+            break;
+
+        auto const* fields = data + offset + header_size; // NOLINT(*pointer-arithmetic)
+        size_t      field  = 0;
+        if ((header.flags & UVC_STREAM_PTS) && field + pts_size <= fields_size)
+        {
+            if (!res.presentation_time)
+                res.presentation_time = read_u32_little_endian(fields + field); // NOLINT(*pointer-arithmetic)
+            field += pts_size;
+        }
+        if ((header.flags & UVC_STREAM_SCR) && field + scr_size <= fields_size)
+        {
+            res.clock_sample = ParsedMetadata::ClockSample{
+                .device_time = read_u32_little_endian(fields + field), // NOLINT(*pointer-arithmetic)
+                .host_time   = std::chrono::steady_clock::time_point{std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds{header.ns})},
+            }; // We keep the last one, one sample per frame is enough
+        }
+        offset += header_size + fields_size;
+    }
+    return res;
+}
+
+void UvcMetadataStream::drain()
+{
+    while (true)
+    {
+        auto buf   = v4l2_buffer{};
+        buf.type   = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (ioctl(_handle, VIDIOC_DQBUF, &buf) == -1)
+            break; // No more metadata for now (EAGAIN)
+
+        auto const metadata = parse_metadata(static_cast<uint8_t const*>(_buffers[buf.index].planes[0].ptr), buf.bytesused); // NOLINT(*constant-array-index)
+        ioctl(_handle, VIDIOC_QBUF, &buf);
+        if (metadata.clock_sample)
+            _device_clock.add_sample(metadata.clock_sample->device_time, metadata.clock_sample->host_time);
+        if (metadata.presentation_time)
+        {
+            _presentation_times[buf.sequence] = *metadata.presentation_time;
+            while (_presentation_times.size() > max_presentation_times_count)
+                _presentation_times.erase(_presentation_times.begin()); // The frames are processed in order, so the oldest ones will never be asked for
+        }
+    }
+}
+
+auto UvcMetadataStream::device_timestamp(uint32_t frame_sequence) -> std::optional<std::chrono::steady_clock::time_point>
+{
+    auto const it = _presentation_times.find(frame_sequence);
+    if (it == _presentation_times.end())
+        return std::nullopt;
+    auto const presentation_time = it->second;
+    _presentation_times.erase(_presentation_times.begin(), std::next(it)); // Keep the metadata of the next frames for the next calls
+    return _device_clock.to_host_time(presentation_time);
+}
+
+} // namespace wcam::internal
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#if defined(__linux__)
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include "DeviceClock.hpp"
+#include "wcam_linux.hpp"
+
+namespace wcam::internal {
+
+/// UVC cameras expose the headers of their USB payloads on a second video node, which contains the camera's own timestamps.
+/// We stream it alongside the frames, in order to know precisely when each frame was captured.
+class UvcMetadataStream {
+public:
+    /// Returns nullptr if the camera has no metadata node, or if we fail to use it
+    [[nodiscard]] static auto open(std::filesystem::path const& video_node_path) -> std::unique_ptr<UvcMetadataStream>;
+
+    explicit UvcMetadataStream(int file_handle)
+        : _handle{file_handle}
+    {}
+    ~UvcMetadataStream();
+    UvcMetadataStream(UvcMetadataStream const&)                        = delete;
+    auto operator=(UvcMetadataStream const&) -> UvcMetadataStream&     = delete;
+    UvcMetadataStream(UvcMetadataStream&&) noexcept                    = delete;
+    auto operator=(UvcMetadataStream&&) noexcept -> UvcMetadataStream& = delete;
+
+    /// Reads all the metadata that the driver has received so far (without blocking), and remembers the presentation times of the last frames.
+    /// Must be called each time we dequeue a video buffer, even if we then drop the frame: otherwise the driver runs out of metadata buffers and stops sending the metadata.
+    void               drain();
+    /// The time at which the camera captured the given frame, converted to our clock. std::nullopt if drain() hasn't received its metadata.
+    /// `frame_sequence` is the sequence number of the frame's v4l2_buffer.
+    [[nodiscard]] auto device_timestamp(uint32_t frame_sequence) -> std::optional<std::chrono::steady_clock::time_point>;
+
+private:
+    [[nodiscard]] auto start() -> bool;
+    /// Unmaps the buffers and gives them back to the driver, otherwise the next stream on this camera wouldn't be able to allocate its own
+    void               release_buffers();
+
+private:
+    FileRAII              _handle;
+    std::array<Buffer, 8> _buffers{};
+    bool                  _is_streaming{false};
+    DeviceClock           _device_clock{};
+
+    static constexpr size_t      max_presentation_times_count{8};
+    std::map<uint32_t, uint32_t> _presentation_times{}; // The PTS of the frames whose metadata arrived before we processed them, by sequence number
+};
+
+} // namespace wcam::internal
+
+#endif
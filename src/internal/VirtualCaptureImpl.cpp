@@ -0,0 +1,29 @@
+#include "VirtualCaptureImpl.hpp"
+#include "Manager.hpp"
+#include "VirtualWebcamsManager.hpp"
+#include "WebcamRequest.hpp"
+
+namespace wcam::internal {
+
+VirtualCaptureImpl::VirtualCaptureImpl(DeviceId const& id, std::shared_ptr<Subscriptions const> subscriptions)
+    : ICaptureImpl{id, std::move(subscriptions)}
+{
+    auto const virtual_webcam = virtual_webcams_manager().find(id);
+    if (!virtual_webcam)
+        throw CaptureException{Error_WebcamUnplugged{}}; // It has been removed in the meantime
+
+    _physical_webcam.emplace(manager()->open_or_get_webcam(virtual_webcam->physical_id));
+    _crop_subscriber = std::make_shared<CropSubscriber>(
+        virtual_webcam->region,
+        [this]() { return is_frame_wanted(); },
+        [this](MaybeImage image) { set_image(std::move(image)); }
+    );
+    _physical_webcam->_request->subscriptions()->add_crop_subscriber(_crop_subscriber);
+}
+
+VirtualCaptureImpl::~VirtualCaptureImpl()
+{
+    _crop_subscriber->disconnect(); // The physical camera might be in the middle of giving us an image, on its own thread
+}
+
+} // namespace wcam::internal
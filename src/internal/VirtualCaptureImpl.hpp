@@ -0,0 +1,24 @@
+#pragma once
+#include <memory>
+#include "../SharedWebcam.hpp"
+#include "ICaptureImpl.hpp"
+
+namespace wcam::internal {
+
+/// The capture of a virtual camera (see add_virtual_webcam()).
+/// It doesn't capture anything itself: it keeps the physical camera open, and receives the region of its images that it is interested in.
+class VirtualCaptureImpl : public ICaptureImpl {
+public:
+    VirtualCaptureImpl(DeviceId const& id, std::shared_ptr<Subscriptions const> subscriptions);
+    ~VirtualCaptureImpl() override;
+    VirtualCaptureImpl(VirtualCaptureImpl const&)                        = delete;
+    auto operator=(VirtualCaptureImpl const&) -> VirtualCaptureImpl&     = delete;
+    VirtualCaptureImpl(VirtualCaptureImpl&&) noexcept                    = delete;
+    auto operator=(VirtualCaptureImpl&&) noexcept -> VirtualCaptureImpl& = delete;
+
+private:
+    std::optional<SharedWebcam>     _physical_webcam{}; // Optional only because it can't be created before we know which camera it is
+    std::shared_ptr<CropSubscriber> _crop_subscriber{};
+};
+
+} // namespace wcam::internal
@@ -0,0 +1,72 @@
+#include "VirtualWebcamsManager.hpp"
+#include <algorithm>
+#include "make_device_id.hpp"
+
+namespace wcam::internal {
+
+/// All the pixel formats support crops that start on even coordinates and have an even size (formats like YUYV and NV12 share their colors between 2 pixels)
+static auto make_even(CropRegion region) -> CropRegion
+{
+    return {
+        .x      = region.x & ~1u,
+        .y      = region.y & ~1u,
+        .width  = std::max(region.width & ~1u, 2u),
+        .height = std::max(region.height & ~1u, 2u),
+    };
+}
+
+auto VirtualWebcamsManager::add(DeviceId const& physical_id, CropRegion region, std::string name) -> DeviceId
+{
+    region        = make_even(region);
+    auto const id = make_device_id(
+        "virtual:" + physical_id.as_string()
+        + ":" + std::to_string(region.x) + "," + std::to_string(region.y)
+        + ":" + std::to_string(region.width) + "x" + std::to_string(region.height)
+    );
+
+    std::scoped_lock lock{_mutex};
+    _virtual_webcams[id] = VirtualWebcam{
+        .name        = std::move(name),
+        .physical_id = physical_id,
+        .region      = region,
+    };
+    return id;
+}
+
+void VirtualWebcamsManager::remove(DeviceId const& id)
+{
+    std::scoped_lock lock{_mutex};
+    _virtual_webcams.erase(id);
+}
+
+auto VirtualWebcamsManager::find(DeviceId const& id) const -> std::optional<VirtualWebcam>
+{
+    std::scoped_lock lock{_mutex};
+    auto const       it = _virtual_webcams.find(id);
+    if (it == _virtual_webcams.end())
+        return std::nullopt;
+    return it->second;
+}
+
+auto VirtualWebcamsManager::infos(std::vector<Info> const& physical_infos) const -> std::vector<Info>
+{
+    auto infos = std::vector<Info>{};
+
+    std::scoped_lock lock{_mutex};
+    for (auto const& [id, virtual_webcam] : _virtual_webcams)
+    {
+        bool const is_plugged_in = std::any_of(physical_infos.begin(), physical_infos.end(), [&](Info const& info) {
+            return info.id == virtual_webcam.physical_id;
+        });
+        if (!is_plugged_in)
+            continue;
+        infos.push_back({
+            .name        = virtual_webcam.name,
+            .id          = id,
+            .resolutions = {Resolution{virtual_webcam.region.width, virtual_webcam.region.height}},
+        });
+    }
+    return infos;
+}
+
+} // namespace wcam::internal
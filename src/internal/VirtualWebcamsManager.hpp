@@ -0,0 +1,39 @@
+#pragma once
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../DeviceId.hpp"
+#include "../Info.hpp"
+#include "../VirtualWebcam.hpp"
+
+namespace wcam::internal {
+
+struct VirtualWebcam {
+    std::string name{};
+    DeviceId    physical_id{};
+    CropRegion  region{};
+};
+
+/// The virtual cameras created by add_virtual_webcam()
+class VirtualWebcamsManager {
+public:
+    auto               add(DeviceId const& physical_id, CropRegion, std::string name) -> DeviceId;
+    void               remove(DeviceId const&);
+    [[nodiscard]] auto find(DeviceId const&) const -> std::optional<VirtualWebcam>;
+    /// The virtual cameras whose physical camera is in `physical_infos`. The others are considered unplugged.
+    [[nodiscard]] auto infos(std::vector<Info> const& physical_infos) const -> std::vector<Info>;
+
+private:
+    std::unordered_map<DeviceId, VirtualWebcam> _virtual_webcams{};
+    mutable std::mutex                          _mutex{};
+};
+
+inline auto virtual_webcams_manager() -> VirtualWebcamsManager&
+{
+    static auto instance = VirtualWebcamsManager{};
+    return instance;
+}
+
+} // namespace wcam::internal
@@ -1,24 +1,140 @@
 #include "WebcamRequest.hpp"
+#include <cassert>
+#include <utility>
 #include "../overloaded.hpp"
+#include "UsbBandwidthBudget.hpp"
 
 namespace wcam::internal {
 
 auto WebcamRequest::image() const -> MaybeImage
 {
+    auto const image_during_restart = [&](MaybeImage image) -> MaybeImage {
+        std::scoped_lock lock{_image_during_restart_mutex};
+        if (!std::holds_alternative<ImageNotInitYet>(image))
+            _image_during_restart.reset(); // The new capture has started, we don't need the old image anymore
+        else if (_image_during_restart)
+            return _image_during_restart;
+        return image;
+    };
+
     return std::visit(
         wcam::overloaded{
-            [](Capture& capture) -> MaybeImage {
-                return capture.image();
+            [&](Capture& capture) -> MaybeImage {
+                return image_during_restart(capture.image());
             },
-            [](CaptureError const& err) -> MaybeImage {
-                return err;
+            [&](CaptureError const& err) -> MaybeImage {
+                return image_during_restart(err);
             },
-            [](CaptureNotInitYet const&) -> MaybeImage {
-                return ImageNotInitYet{};
+            [&](CaptureNotInitYet const&) -> MaybeImage {
+                return image_during_restart(ImageNotInitYet{});
             },
         },
         _maybe_capture
     );
 }
 
+void WebcamRequest::keep_last_image_during_restart()
+{
+    auto* const capture = std::get_if<Capture>(&_maybe_capture);
+    if (!capture)
+        return;
+    auto image = capture->image();
+    if (auto* const last_image = std::get_if<std::shared_ptr<Image const>>(&image))
+    {
+        std::scoped_lock lock{_image_during_restart_mutex};
+        _image_during_restart = std::move(*last_image);
+    }
+}
+
+auto WebcamRequest::request_still(Resolution resolution) -> std::future<MaybeStill>
+{
+    auto             promise = std::promise<MaybeStill>{};
+    auto             future  = promise.get_future();
+    std::scoped_lock lock{_still_requests_mutex};
+    _still_requests.push_back({resolution, std::move(promise)});
+    return future;
+}
+
+void WebcamRequest::capture_pending_stills()
+{
+    if (std::holds_alternative<CaptureNotInitYet>(_maybe_capture))
+        return; // Wait until the capture is started
+    auto requests = [&]() { // IIFE
+        std::scoped_lock lock{_still_requests_mutex};
+        return std::exchange(_still_requests, {});
+    }();
+    for (auto& request : requests)
+    {
+        std::visit(
+            wcam::overloaded{
+                [&](Capture& capture) {
+                    request.promise.set_value(capture.capture_still(request.resolution));
+                },
+                [&](CaptureError const& err) {
+                    request.promise.set_value(err);
+                },
+                [](CaptureNotInitYet const&) {
+                    assert(false);
+                },
+            },
+            _maybe_capture
+        );
+    }
+}
+
+auto WebcamRequest::request_burst(size_t frames_count, std::vector<PooledBuffer> buffers) -> std::future<MaybeBurst>
+{
+    auto             promise = std::promise<MaybeBurst>{};
+    auto             future  = promise.get_future();
+    std::scoped_lock lock{_burst_requests_mutex};
+    _burst_requests.push_back({frames_count, std::move(buffers), std::move(promise)});
+    return future;
+}
+
+void WebcamRequest::start_pending_bursts()
+{
+    if (std::holds_alternative<CaptureNotInitYet>(_maybe_capture))
+        return; // Wait until the capture is started
+    auto requests = [&]() { // IIFE
+        std::scoped_lock lock{_burst_requests_mutex};
+        return std::exchange(_burst_requests, {});
+    }();
+    for (auto& request : requests)
+    {
+        std::visit(
+            wcam::overloaded{
+                [&](Capture& capture) {
+                    capture.start_burst(std::move(request));
+                },
+                [&](CaptureError const& err) {
+                    request.promise.set_value(err);
+                },
+                [](CaptureNotInitYet const&) {
+                    assert(false);
+                },
+            },
+            _maybe_capture
+        );
+    }
+}
+
+void WebcamRequest::remember_usb_bandwidth_failure()
+{
+    _usb_bandwidth_failure = UsbBandwidthFailure{
+        .budget_generation = usb_bandwidth_budget().generation(),
+        .time              = std::chrono::steady_clock::now(),
+    };
+}
+
+auto WebcamRequest::is_waiting_for_usb_bandwidth() const -> bool
+{
+    if (!_usb_bandwidth_failure)
+        return false;
+    auto const* const error = std::get_if<CaptureError>(&_maybe_capture);
+    if (!error || !std::holds_alternative<Error_NotEnoughUsbBandwidth>(*error))
+        return false;
+    return _usb_bandwidth_failure->budget_generation == usb_bandwidth_budget().generation()
+           && std::chrono::steady_clock::now() - _usb_bandwidth_failure->time < std::chrono::seconds{5};
+}
+
 } // namespace wcam::internal
\ No newline at end of file
@@ -1,6 +1,13 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <variant>
+#include <vector>
 #include "../DeviceId.hpp"
+#include "../Still.hpp"
 #include "Capture.hpp"
 
 namespace wcam::internal {
@@ -18,10 +25,49 @@ public:
 
     [[nodiscard]] auto id() const -> DeviceId const& { return _id; }
     [[nodiscard]] auto maybe_capture() -> MaybeCapture& { return _maybe_capture; }
+    [[nodiscard]] auto subscriptions() -> std::shared_ptr<Subscriptions> const& { return _subscriptions; }
+
+    /// Must be called before destroying the capture in order to restart it: image() will keep returning its last image until the new capture publishes its first one, instead of ImageNotInitYet
+    void keep_last_image_during_restart();
+
+    /// The still will be captured by the Manager thread, see capture_pending_stills()
+    [[nodiscard]] auto request_still(Resolution) -> std::future<MaybeStill>;
+    /// Must only be called from the Manager thread. Stills wait until the capture is started, and fail if it is in an error state.
+    void               capture_pending_stills();
+    /// The burst will be given to the capture by the Manager thread, see start_pending_bursts()
+    [[nodiscard]] auto request_burst(size_t frames_count, std::vector<PooledBuffer> buffers) -> std::future<MaybeBurst>;
+    /// Must only be called from the Manager thread. Bursts wait until the capture is started, and fail if it is in an error state.
+    void               start_pending_bursts();
+
+    /// When the capture failed because there wasn't enough USB bandwidth, retrying is pointless until another of our captures gives back some bandwidth.
+    /// We still retry from time to time, because the bandwidth might have been used by another application.
+    void               remember_usb_bandwidth_failure();
+    [[nodiscard]] auto is_waiting_for_usb_bandwidth() const -> bool;
+
+private:
+    struct UsbBandwidthFailure {
+        uint64_t                              budget_generation{};
+        std::chrono::steady_clock::time_point time{};
+    };
+
+    struct StillRequest {
+        Resolution                resolution;
+        std::promise<MaybeStill> promise;
+    };
 
 private:
-    DeviceId             _id;
-    mutable MaybeCapture _maybe_capture{CaptureNotInitYet{}};
+    DeviceId                           _id;
+    std::shared_ptr<Subscriptions>     _subscriptions{std::make_shared<Subscriptions>()};
+    mutable MaybeCapture               _maybe_capture{CaptureNotInitYet{}};
+    std::optional<UsbBandwidthFailure> _usb_bandwidth_failure{};
+
+    mutable std::shared_ptr<Image const> _image_during_restart{};
+    mutable std::mutex                   _image_during_restart_mutex{};
+
+    std::vector<StillRequest> _still_requests{};
+    std::mutex                _still_requests_mutex{};
+    std::vector<BurstRequest> _burst_requests{};
+    std::mutex                _burst_requests_mutex{};
 };
 
 } // namespace wcam::internal
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+#include "ThreadSettingsManager.hpp"
+
+namespace wcam::internal {
+
+namespace {
+struct CurrentWorker {
+    WorkStealingPool const* pool{nullptr};
+    size_t                  index{0};
+};
+} // namespace
+
+thread_local CurrentWorker current_worker{}; // NOLINT(*avoid-non-const-global-variables)
+
+WorkStealingPool::WorkStealingPool(size_t workers_count)
+{
+    workers_count = std::max<size_t>(workers_count, 1);
+    for (size_t i = 0; i < workers_count; ++i)
+        _queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < workers_count; ++i)
+        _threads.emplace_back(&WorkStealingPool::thread_job, std::ref(*this), i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::scoped_lock lock{_sleep_mutex};
+        _wants_to_stop = true;
+    }
+    _wake_up.notify_all();
+    for (auto& thread : _threads)
+        thread.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> job)
+{
+    auto const queue_index = current_worker.pool == this
+                                 ? current_worker.index
+                                 : _next_queue.fetch_add(1) % _queues.size();
+    {
+        auto&            queue = *_queues[queue_index];
+        std::scoped_lock lock{queue.mutex};
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        std::scoped_lock lock{_sleep_mutex};
+        _pending_jobs_count++;
+    }
+    _wake_up.notify_one();
+}
+
+auto WorkStealingPool::try_pop(size_t worker_index) -> std::function<void()>
+{
+    { // Take the most recent job of our own queue, its data is most likely still in our cache
+        auto&            queue = *_queues[worker_index];
+        std::scoped_lock lock{queue.mutex};
+        if (!queue.jobs.empty())
+        {
+            auto job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            return job;
+        }
+    }
+    for (size_t offset = 1; offset < _queues.size(); ++offset) // Steal the oldest job of another queue
+    {
+        auto&            queue = *_queues[(worker_index + offset) % _queues.size()];
+        std::scoped_lock lock{queue.mutex};
+        if (!queue.jobs.empty())
+        {
+            auto job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            return job;
+        }
+    }
+    return {};
+}
+
+void WorkStealingPool::thread_job(WorkStealingPool& self, size_t worker_index)
+{
+    current_worker = {&self, worker_index};
+    while (true)
+    {
+        thread_settings_manager().apply_settings_if_they_changed(ThreadRole::Pipeline);
+        {
+            std::unique_lock lock{self._sleep_mutex};
+            self._wake_up.wait(lock, [&]() { return self._pending_jobs_count > 0 || self._wants_to_stop; });
+            if (self._wants_to_stop)
+                return;
+            self._pending_jobs_count--; // Reserves one of the jobs for us
+        }
+        // The job we reserved is in one of the queues, but another worker might pop it before us, in which case we will find the one that it had reserved
+        auto job = self.try_pop(worker_index);
+        while (!job)
+            job = self.try_pop(worker_index);
+        job();
+    }
+}
+
+auto work_stealing_pool() -> WorkStealingPool&
+{
+    static auto instance = WorkStealingPool{std::max(std::thread::hardware_concurrency(), 2u) - 1}; // Leave one core for the capture threads
+    return instance;
+}
+
+} // namespace wcam::internal
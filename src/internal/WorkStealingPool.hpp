@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wcam::internal {
+
+/// Runs jobs on a fixed set of threads.
+/// Each thread has its own queue: jobs submitted from a worker go to its own queue (which keeps the data hot in its cache), and idle workers steal jobs from the other queues.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t workers_count);
+    ~WorkStealingPool();
+    WorkStealingPool(WorkStealingPool const&)                        = delete;
+    auto operator=(WorkStealingPool const&) -> WorkStealingPool&     = delete;
+    WorkStealingPool(WorkStealingPool&&) noexcept                    = delete;
+    auto operator=(WorkStealingPool&&) noexcept -> WorkStealingPool& = delete;
+
+    void submit(std::function<void()> job);
+
+private:
+    static void thread_job(WorkStealingPool&, size_t worker_index);
+    [[nodiscard]] auto try_pop(size_t worker_index) -> std::function<void()>;
+
+private:
+    struct Queue {
+        std::deque<std::function<void()>> jobs{};
+        std::mutex                        mutex{};
+    };
+    std::vector<std::unique_ptr<Queue>> _queues{};
+    std::atomic<size_t>                 _next_queue{0};
+
+    size_t                  _pending_jobs_count{0};
+    bool                    _wants_to_stop{false};
+    std::mutex              _sleep_mutex{};
+    std::condition_variable _wake_up{};
+
+    std::vector<std::thread> _threads{}; // Must be initialized last, to make sure that everything else is init when the threads start their job
+};
+
+/// The pool that runs the stages of the pipelines. Created the first time a pipeline needs it.
+auto work_stealing_pool() -> WorkStealingPool&;
+
+} // namespace wcam::internal
@@ -0,0 +1,250 @@
+#include <optional>
+#include <string>
+#include "ThreadSettingsManager.hpp"
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace wcam::internal {
+
+#if defined(_WIN32)
+
+static auto as_windows_priority(ThreadPriority priority) -> int
+{
+    switch (priority)
+    {
+    case ThreadPriority::Lowest:
+        return THREAD_PRIORITY_LOWEST;
+    case ThreadPriority::Low:
+        return THREAD_PRIORITY_BELOW_NORMAL;
+    case ThreadPriority::Normal:
+        return THREAD_PRIORITY_NORMAL;
+    case ThreadPriority::High:
+        return THREAD_PRIORITY_ABOVE_NORMAL;
+    case ThreadPriority::Highest:
+        return THREAD_PRIORITY_HIGHEST;
+    case ThreadPriority::Realtime:
+        return THREAD_PRIORITY_TIME_CRITICAL;
+    }
+    return THREAD_PRIORITY_NORMAL;
+}
+
+static void set_thread_name(std::string const& name)
+{
+    // SetThreadDescription() only exists since Windows 10 1607, and is missing from some toolchains, so we look it up at runtime
+    using SetThreadDescriptionFn = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+    auto const set_thread_description = reinterpret_cast<SetThreadDescriptionFn>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")); // NOLINT(*reinterpret-cast)
+    if (set_thread_description == nullptr)
+        return;
+    auto const wide_name_length = MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, nullptr, 0);
+    auto       wide_name        = std::wstring(static_cast<size_t>(wide_name_length), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, wide_name.data(), wide_name_length);
+    set_thread_description(GetCurrentThread(), wide_name.c_str());
+}
+
+static void set_priority(ThreadPriority priority)
+{
+    thread_local auto original_priority = std::optional<int>{}; // Set while we are overriding the priority that the thread had
+    if (priority == ThreadPriority::Normal)
+    {
+        if (original_priority) // Otherwise we keep the priority chosen by the application
+            SetThreadPriority(GetCurrentThread(), *original_priority);
+        original_priority.reset();
+        return;
+    }
+    if (!original_priority)
+        original_priority = GetThreadPriority(GetCurrentThread());
+    SetThreadPriority(GetCurrentThread(), as_windows_priority(priority));
+}
+
+static void set_affinity(std::vector<size_t> const& cpu_affinity)
+{
+    thread_local auto original_affinity_mask = std::optional<DWORD_PTR>{}; // Set while we are overriding the affinity that the thread had
+    auto              affinity_mask          = DWORD_PTR{0};
+    for (size_t const cpu : cpu_affinity)
+    {
+        if (cpu < sizeof(DWORD_PTR) * 8) // We only support the first processor group
+            affinity_mask |= DWORD_PTR{1} << cpu;
+    }
+    if (affinity_mask == 0)
+    {
+        if (original_affinity_mask) // Otherwise we keep the affinity chosen by the application
+            SetThreadAffinityMask(GetCurrentThread(), *original_affinity_mask);
+        original_affinity_mask.reset();
+        return;
+    }
+    auto const previous_affinity_mask = SetThreadAffinityMask(GetCurrentThread(), affinity_mask); // Returns the previous mask, or 0 if it failed
+    if (previous_affinity_mask != 0 && !original_affinity_mask)
+        original_affinity_mask = previous_affinity_mask;
+}
+
+void apply_thread_settings(ThreadSettings const& settings, char const* default_name)
+{
+    set_thread_name(settings.name.empty() ? default_name : settings.name);
+    set_priority(settings.priority);
+    set_affinity(settings.cpu_affinity);
+}
+
+#elif defined(__APPLE__)
+
+namespace {
+struct SchedulingPolicy {
+    int         policy{};
+    sched_param param{};
+};
+} // namespace
+
+void apply_thread_settings(ThreadSettings const& settings, char const* default_name)
+{
+    pthread_setname_np(settings.name.empty() ? default_name : settings.name.c_str());
+
+    thread_local auto original_policy = std::optional<SchedulingPolicy>{}; // Set while we are overriding the priority that the thread had
+    if (settings.priority == ThreadPriority::Normal)
+    {
+        if (original_policy) // Otherwise we keep the priority chosen by the application
+            pthread_setschedparam(pthread_self(), original_policy->policy, &original_policy->param);
+        original_policy.reset();
+        return;
+    }
+    if (!original_policy)
+    {
+        auto policy = SchedulingPolicy{};
+        if (pthread_getschedparam(pthread_self(), &policy.policy, &policy.param) == 0)
+            original_policy = policy;
+    }
+
+    auto param = sched_param{};
+    if (settings.priority == ThreadPriority::Realtime)
+    {
+        param.sched_priority = settings.realtime_priority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0)
+            return;
+    }
+    int const min_priority = sched_get_priority_min(SCHED_OTHER);
+    int const max_priority = sched_get_priority_max(SCHED_OTHER);
+    int const level        = settings.priority == ThreadPriority::Realtime ? static_cast<int>(ThreadPriority::Highest) : static_cast<int>(settings.priority);
+    param.sched_priority   = min_priority + (max_priority - min_priority) * level / static_cast<int>(ThreadPriority::Highest);
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    // Affinity is not supported by MacOS
+}
+
+#elif defined(__linux__)
+
+static auto as_nice_value(ThreadPriority priority) -> int
+{
+    switch (priority)
+    {
+    case ThreadPriority::Lowest:
+        return 10;
+    case ThreadPriority::Low:
+        return 5;
+    case ThreadPriority::Normal:
+        return 0;
+    case ThreadPriority::High:
+        return -5;
+    case ThreadPriority::Highest:
+    case ThreadPriority::Realtime:
+        return -10;
+    }
+    return 0;
+}
+
+namespace {
+struct OriginalPriority {
+    int         policy{};
+    sched_param param{};
+    int         nice{};
+};
+} // namespace
+
+static auto current_thread_id() -> id_t
+{
+    return static_cast<id_t>(syscall(SYS_gettid));
+}
+
+static void set_priority(ThreadSettings const& settings)
+{
+    thread_local auto original_priority = std::optional<OriginalPriority>{}; // Set while we are overriding the priority that the thread had
+    if (settings.priority == ThreadPriority::Normal)
+    {
+        if (original_priority) // Otherwise we keep the priority chosen by the application (e.g. with chrt or nice)
+        {
+            pthread_setschedparam(pthread_self(), original_priority->policy, &original_priority->param);
+            setpriority(PRIO_PROCESS, current_thread_id(), original_priority->nice);
+        }
+        original_priority.reset();
+        return;
+    }
+    if (!original_priority)
+    {
+        auto priority = OriginalPriority{};
+        if (pthread_getschedparam(pthread_self(), &priority.policy, &priority.param) == 0)
+        {
+            errno         = 0;
+            priority.nice = getpriority(PRIO_PROCESS, current_thread_id()); // -1 is a valid nice value, so we need errno to detect errors
+            if (errno == 0)
+                original_priority = priority;
+        }
+    }
+
+    auto param = sched_param{};
+    if (settings.priority == ThreadPriority::Realtime)
+    {
+        param.sched_priority = settings.realtime_priority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0)
+            return;
+        // We are not allowed to use SCHED_FIFO, fall back to the highest normal priority
+    }
+    param.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    // On Linux the nice value is per-thread, and raising the priority (negative values) might not be allowed, in which case we keep the previous one
+    setpriority(PRIO_PROCESS, current_thread_id(), as_nice_value(settings.priority));
+}
+
+static void set_affinity(std::vector<size_t> const& cpu_affinity)
+{
+    thread_local auto original_cpu_set = std::optional<cpu_set_t>{}; // Set while we are overriding the affinity that the thread had
+    if (cpu_affinity.empty())
+    {
+        if (original_cpu_set) // Otherwise we keep the affinity chosen by the application (e.g. with taskset, or by its cgroup)
+            pthread_setaffinity_np(pthread_self(), sizeof(*original_cpu_set), &*original_cpu_set);
+        original_cpu_set.reset();
+        return;
+    }
+    if (!original_cpu_set)
+    {
+        auto cpu_set = cpu_set_t{};
+        if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0)
+            original_cpu_set = cpu_set;
+    }
+
+    auto cpu_set = cpu_set_t{};
+    CPU_ZERO(&cpu_set);
+    for (size_t const cpu : cpu_affinity)
+    {
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &cpu_set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+}
+
+void apply_thread_settings(ThreadSettings const& settings, char const* default_name)
+{
+    auto const name = settings.name.empty() ? std::string{default_name} : settings.name;
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()); // Linux names are limited to 16 characters, including the null terminator. It fails if the name is longer.
+    set_priority(settings);
+    set_affinity(settings.cpu_affinity);
+}
+
+#endif
+
+} // namespace wcam::internal
@@ -0,0 +1,299 @@
+#include "demosaic.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include "BufferPool.hpp"
+#include "unpack_raw10.hpp"
+
+// The inner loops are branch-free: the position of the colors only depends on the parity of the row and of the column, which we handle with template parameters.
+// This keeps them cheap, and lets the compiler vectorize them where it can, without any platform-specific intrinsics.
+
+namespace wcam::internal {
+
+auto demosaiced_resolution(Resolution sensor_resolution, DemosaicMethod method) -> Resolution
+{
+    if (method != DemosaicMethod::Superpixel)
+        return sensor_resolution;
+    return Resolution{std::max<Resolution::DataType>(sensor_resolution.width() / 2, 1), std::max<Resolution::DataType>(sensor_resolution.height() / 2, 1)};
+}
+
+/// The position of the red pixel in the 2x2 block. Blue is on the opposite corner, and green on the two others.
+struct RedPosition {
+    uint32_t x;
+    uint32_t y;
+};
+
+static auto red_position(BayerPattern pattern) -> RedPosition
+{
+    switch (pattern)
+    {
+    case BayerPattern::RGGB:
+        return {0, 0};
+    case BayerPattern::GRBG:
+        return {1, 0};
+    case BayerPattern::GBRG:
+        return {0, 1};
+    case BayerPattern::BGGR:
+        return {1, 1};
+    }
+    return {0, 0};
+}
+
+template<size_t Channels>
+static void write_pixel(uint8_t* out, uint32_t r, uint32_t g, uint32_t b)
+{
+    if constexpr (Channels == 1)
+    {
+        out[0] = static_cast<uint8_t>((r + 2 * g + b) / 4); // NOLINT(*pointer-arithmetic) Cheap approximation of the luminance
+    }
+    else
+    {
+        out[0] = static_cast<uint8_t>(r); // NOLINT(*pointer-arithmetic)
+        out[1] = static_cast<uint8_t>(g); // NOLINT(*pointer-arithmetic)
+        out[2] = static_cast<uint8_t>(b); // NOLINT(*pointer-arithmetic)
+        if constexpr (Channels == 4)
+            out[3] = 255; // NOLINT(*pointer-arithmetic)
+    }
+}
+
+/// Green at a red or blue pixel
+template<bool EdgeAware>
+static auto interpolate_green(uint32_t left, uint32_t right, uint32_t up, uint32_t down) -> uint32_t
+{
+    if constexpr (EdgeAware)
+    {
+        auto const horizontal_gradient = std::abs(static_cast<int>(left) - static_cast<int>(right));
+        auto const vertical_gradient   = std::abs(static_cast<int>(up) - static_cast<int>(down));
+        return horizontal_gradient < vertical_gradient   ? (left + right + 1) / 2
+               : vertical_gradient < horizontal_gradient ? (up + down + 1) / 2
+                                                         : (left + right + up + down + 2) / 4;
+    }
+    else
+    {
+        return (left + right + up + down + 2) / 4;
+    }
+}
+
+/// Slow but handles the borders of the image, by mirroring it (which keeps the colors of the neighbours right)
+template<size_t Channels, bool EdgeAware>
+static void demosaic_pixel(uint8_t const* raw, size_t bytes_per_line, Resolution resolution, RedPosition red, uint32_t x, uint32_t y, uint8_t* out)
+{
+    auto const mirror = [](int64_t i, uint32_t size) -> uint32_t {
+        if (i < 0)
+            return static_cast<uint32_t>(std::min<int64_t>(-i, size - 1));
+        if (i >= size)
+            return static_cast<uint32_t>(std::max<int64_t>(2 * static_cast<int64_t>(size) - 2 - i, 0));
+        return static_cast<uint32_t>(i);
+    };
+    auto const at = [&](int64_t dx, int64_t dy) -> uint32_t {
+        return raw[mirror(y + dy, resolution.height()) * bytes_per_line + mirror(x + dx, resolution.width())]; // NOLINT(*pointer-arithmetic)
+    };
+
+    bool const is_red_row    = (y & 1) == red.y;
+    bool const is_chroma_col = (x & 1) == red.x; // On red rows, chroma columns are red. On blue rows, they are green.
+    auto const cross         = interpolate_green<EdgeAware>(at(-1, 0), at(1, 0), at(0, -1), at(0, 1));
+    auto const diagonal      = (at(-1, -1) + at(1, -1) + at(-1, 1) + at(1, 1) + 2) / 4;
+    auto const horizontal    = (at(-1, 0) + at(1, 0) + 1) / 2;
+    auto const vertical      = (at(0, -1) + at(0, 1) + 1) / 2;
+    if (is_red_row && is_chroma_col) // Red
+        write_pixel<Channels>(out, at(0, 0), cross, diagonal);
+    else if (!is_red_row && !is_chroma_col) // Blue
+        write_pixel<Channels>(out, diagonal, cross, at(0, 0));
+    else if (is_red_row) // Green, between two reds
+        write_pixel<Channels>(out, horizontal, at(0, 0), vertical);
+    else // Green, between two blues
+        write_pixel<Channels>(out, vertical, at(0, 0), horizontal);
+}
+
+/// Handles the inside of a row, where all the neighbours exist.
+/// `ChromaFirst` tells whether the even columns are red (on a red row) or blue (on a blue row), instead of green.
+template<size_t Channels, bool EdgeAware, bool IsRedRow, bool ChromaFirst>
+static void demosaic_row(uint8_t const* above, uint8_t const* row, uint8_t const* below, uint32_t width, uint8_t* out)
+{
+    // Each iteration handles one pair of pixels, starting at an even column: one red or blue, and one green
+    for (uint32_t x = 2; x + 2 < width; x += 2)
+    {
+        uint32_t const chroma_x = ChromaFirst ? x : x + 1;
+        uint32_t const green_x  = ChromaFirst ? x + 1 : x;
+        {
+            // Chroma pixel: its own color, green from the cross, the other chroma from the diagonals
+            auto const own   = static_cast<uint32_t>(row[chroma_x]);                                                                                                          // NOLINT(*pointer-arithmetic)
+            auto const green = interpolate_green<EdgeAware>(row[chroma_x - 1], row[chroma_x + 1], above[chroma_x], below[chroma_x]);                                          // NOLINT(*pointer-arithmetic)
+            auto const other = (static_cast<uint32_t>(above[chroma_x - 1]) + above[chroma_x + 1] + below[chroma_x - 1] + below[chroma_x + 1] + 2) / 4; // NOLINT(*pointer-arithmetic)
+            if constexpr (IsRedRow)
+                write_pixel<Channels>(out + static_cast<size_t>(chroma_x) * Channels, own, green, other); // NOLINT(*pointer-arithmetic)
+            else
+                write_pixel<Channels>(out + static_cast<size_t>(chroma_x) * Channels, other, green, own); // NOLINT(*pointer-arithmetic)
+        }
+        {
+            // Green pixel: the chroma of the row from its left and right neighbours, the other chroma from above and below
+            auto const green      = static_cast<uint32_t>(row[green_x]);                                // NOLINT(*pointer-arithmetic)
+            auto const horizontal = (static_cast<uint32_t>(row[green_x - 1]) + row[green_x + 1] + 1) / 2; // NOLINT(*pointer-arithmetic)
+            auto const vertical   = (static_cast<uint32_t>(above[green_x]) + below[green_x] + 1) / 2;     // NOLINT(*pointer-arithmetic)
+            if constexpr (IsRedRow)
+                write_pixel<Channels>(out + static_cast<size_t>(green_x) * Channels, horizontal, green, vertical); // NOLINT(*pointer-arithmetic)
+            else
+                write_pixel<Channels>(out + static_cast<size_t>(green_x) * Channels, vertical, green, horizontal); // NOLINT(*pointer-arithmetic)
+        }
+    }
+}
+
+template<size_t Channels, bool EdgeAware>
+static void demosaic_interpolate(uint8_t const* raw, size_t bytes_per_line, Resolution resolution, RedPosition red, uint8_t* out)
+{
+    auto const width           = resolution.width();
+    auto const height          = resolution.height();
+    auto const out_row_size    = static_cast<size_t>(width) * Channels;
+    auto const last_inner_x    = width >= 4 ? width - 2 - (width % 2) : 0; // The inner loop stops before the last complete pair of columns, the rest is handled by the slow path
+    auto const border_pixel_at = [&](uint32_t x, uint32_t y) {
+        demosaic_pixel<Channels, EdgeAware>(raw, bytes_per_line, resolution, red, x, y, out + y * out_row_size + static_cast<size_t>(x) * Channels); // NOLINT(*pointer-arithmetic)
+    };
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        if (y == 0 || y + 1 == height || width < 4)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+                border_pixel_at(x, y);
+            continue;
+        }
+
+        auto const* above        = raw + (y - 1) * bytes_per_line; // NOLINT(*pointer-arithmetic)
+        auto const* row          = raw + y * bytes_per_line;       // NOLINT(*pointer-arithmetic)
+        auto const* below        = raw + (y + 1) * bytes_per_line; // NOLINT(*pointer-arithmetic)
+        auto*       out_row      = out + y * out_row_size;         // NOLINT(*pointer-arithmetic)
+        bool const  is_red_row   = (y & 1) == red.y;
+        bool const  chroma_first = red.x == 0;
+        if (is_red_row && chroma_first)
+            demosaic_row<Channels, EdgeAware, true, true>(above, row, below, width, out_row);
+        else if (is_red_row)
+            demosaic_row<Channels, EdgeAware, true, false>(above, row, below, width, out_row);
+        else if (chroma_first) // On blue rows, blue is on the columns that don't have red
+            demosaic_row<Channels, EdgeAware, false, false>(above, row, below, width, out_row);
+        else
+            demosaic_row<Channels, EdgeAware, false, true>(above, row, below, width, out_row);
+
+        border_pixel_at(0, y);
+        border_pixel_at(1, y);
+        for (uint32_t x = last_inner_x; x < width; ++x)
+            border_pixel_at(x, y);
+    }
+}
+
+template<size_t Channels>
+static void demosaic_superpixel(uint8_t const* raw, size_t bytes_per_line, Resolution sensor_resolution, RedPosition red, uint8_t* out)
+{
+    auto const resolution = demosaiced_resolution(sensor_resolution, DemosaicMethod::Superpixel);
+    for (uint32_t y = 0; y < resolution.height(); ++y)
+    {
+        auto const* red_row  = raw + (2 * y + red.y) * bytes_per_line;     // NOLINT(*pointer-arithmetic)
+        auto const* blue_row = raw + (2 * y + 1 - red.y) * bytes_per_line; // NOLINT(*pointer-arithmetic)
+        auto*       out_row  = out + static_cast<size_t>(y) * resolution.width() * Channels; // NOLINT(*pointer-arithmetic)
+        for (uint32_t x = 0; x < resolution.width(); ++x)
+        {
+            auto const r = static_cast<uint32_t>(red_row[2 * x + red.x]);                                              // NOLINT(*pointer-arithmetic)
+            auto const g = (static_cast<uint32_t>(red_row[2 * x + 1 - red.x]) + blue_row[2 * x + red.x] + 1) / 2; // NOLINT(*pointer-arithmetic)
+            auto const b = static_cast<uint32_t>(blue_row[2 * x + 1 - red.x]);                                         // NOLINT(*pointer-arithmetic)
+            write_pixel<Channels>(out_row + static_cast<size_t>(x) * Channels, r, g, b);                                // NOLINT(*pointer-arithmetic)
+        }
+    }
+}
+
+template<size_t Channels>
+static void demosaic_impl(uint8_t const* raw, size_t bytes_per_line, Resolution resolution, RedPosition red, DemosaicMethod method, uint8_t* out)
+{
+    switch (method)
+    {
+    case DemosaicMethod::Bilinear:
+        demosaic_interpolate<Channels, false>(raw, bytes_per_line, resolution, red, out);
+        break;
+    case DemosaicMethod::EdgeAware:
+        demosaic_interpolate<Channels, true>(raw, bytes_per_line, resolution, red, out);
+        break;
+    case DemosaicMethod::Superpixel:
+        demosaic_superpixel<Channels>(raw, bytes_per_line, resolution, red, out);
+        break;
+    }
+}
+
+void demosaic(uint8_t const* raw, size_t bytes_per_line, Resolution sensor_resolution, BayerPattern pattern, DemosaicMethod method, uint8_t* out, size_t channels)
+{
+    auto const red = red_position(pattern);
+    if (channels == 1)
+        demosaic_impl<1>(raw, bytes_per_line, sensor_resolution, red, method, out);
+    else if (channels == 3)
+        demosaic_impl<3>(raw, bytes_per_line, sensor_resolution, red, method, out);
+    else if (channels == 4)
+        demosaic_impl<4>(raw, bytes_per_line, sensor_resolution, red, method, out);
+}
+
+auto bayer_format(HistoryFrameFormat format) -> std::optional<BayerFormat>
+{
+    switch (format)
+    {
+    case HistoryFrameFormat::BayerRGGB8:
+        return BayerFormat{BayerPattern::RGGB, false};
+    case HistoryFrameFormat::BayerBGGR8:
+        return BayerFormat{BayerPattern::BGGR, false};
+    case HistoryFrameFormat::BayerGRBG8:
+        return BayerFormat{BayerPattern::GRBG, false};
+    case HistoryFrameFormat::BayerGBRG8:
+        return BayerFormat{BayerPattern::GBRG, false};
+    case HistoryFrameFormat::BayerRGGB10P:
+        return BayerFormat{BayerPattern::RGGB, true};
+    case HistoryFrameFormat::BayerBGGR10P:
+        return BayerFormat{BayerPattern::BGGR, true};
+    case HistoryFrameFormat::BayerGRBG10P:
+        return BayerFormat{BayerPattern::GRBG, true};
+    case HistoryFrameFormat::BayerGBRG10P:
+        return BayerFormat{BayerPattern::GBRG, true};
+    default:
+        return std::nullopt;
+    }
+}
+
+auto set_bayer_data(Image& image, uint8_t const* data, size_t data_size, size_t bytes_per_line, Resolution sensor_resolution, FirstRowIs row_order, BayerFormat format, BayerSettings const& settings) -> bool
+{
+    auto const row_size = format.is_raw10_packed ? static_cast<size_t>(sensor_resolution.width()) * 5 / 4 : static_cast<size_t>(sensor_resolution.width());
+    bytes_per_line      = std::max(bytes_per_line, row_size); // Some drivers leave bytesperline to 0 when the rows are not padded
+    if (data_size < bytes_per_line * sensor_resolution.height())
+        return false;
+
+    auto const* raw      = data;
+    auto        unpacked = PooledBuffer{};
+    if (format.is_raw10_packed)
+    {
+        unpacked = buffer_pool().acquire(sensor_resolution.pixels_count());
+        unpack_raw10_to_8bits(data, bytes_per_line, sensor_resolution, unpacked.data());
+        raw            = unpacked.data();
+        bytes_per_line = sensor_resolution.width();
+    }
+
+    auto const resolution = demosaiced_resolution(sensor_resolution, settings.method);
+    switch (settings.output)
+    {
+    case DemosaicOutput::RGB24:
+    {
+        auto rgb = buffer_pool().acquire(RGB24::data_length(resolution));
+        demosaic(raw, bytes_per_line, sensor_resolution, format.pattern, settings.method, rgb.data(), 3);
+        image.set_data(ImageDataView<RGB24>{rgb.shared_data(), rgb.size(), resolution, row_order});
+        break;
+    }
+    case DemosaicOutput::RGBA32:
+    {
+        auto rgba = buffer_pool().acquire(RGBA32::data_length(resolution));
+        demosaic(raw, bytes_per_line, sensor_resolution, format.pattern, settings.method, rgba.data(), 4);
+        image.set_data(ImageDataView<RGBA32>{rgba.shared_data(), rgba.size(), resolution, row_order});
+        break;
+    }
+    case DemosaicOutput::GRAY8:
+    {
+        auto gray = buffer_pool().acquire(GRAY8::data_length(resolution));
+        demosaic(raw, bytes_per_line, sensor_resolution, format.pattern, settings.method, gray.data(), 1);
+        image.set_data(ImageDataView<GRAY8>{gray.shared_data(), gray.size(), resolution, row_order});
+        break;
+    }
+    }
+    return true;
+}
+
+} // namespace wcam::internal
\ No newline at end of file
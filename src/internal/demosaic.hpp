@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include "../BayerSettings.hpp"
+#include "../History.hpp"
+#include "../Image.hpp"
+#include "../Resolution.hpp"
+
+namespace wcam::internal {
+
+/// Superpixel halves the resolution, the other methods keep it
+auto demosaiced_resolution(Resolution sensor_resolution, DemosaicMethod) -> Resolution;
+
+/// `raw` is an 8-bit Bayer image whose rows are `bytes_per_line` apart.
+/// `out` must be big enough for demosaiced_resolution() pixels of `channels` bytes each: 1 (gray), 3 (RGB) or 4 (RGBA).
+void demosaic(uint8_t const* raw, size_t bytes_per_line, Resolution sensor_resolution, BayerPattern, DemosaicMethod, uint8_t* out, size_t channels);
+
+struct BayerFormat {
+    BayerPattern pattern;
+    bool         is_raw10_packed;
+};
+
+/// std::nullopt if the format is not a Bayer one
+auto bayer_format(HistoryFrameFormat) -> std::optional<BayerFormat>;
+
+/// Demosaics the frame as described by the settings, and gives the result to the image.
+/// `bytes_per_line` is the distance between rows, as reported by the driver (it includes the padding that some drivers add at the end of the rows). 0 means that the rows are not padded.
+/// Returns false, and leaves the image untouched, if `data_size` is too small to contain all the rows (e.g. the frame was truncated).
+[[nodiscard]] auto set_bayer_data(Image&, uint8_t const* data, size_t data_size, size_t bytes_per_line, Resolution, FirstRowIs, BayerFormat, BayerSettings const&) -> bool;
+
+} // namespace wcam::internal
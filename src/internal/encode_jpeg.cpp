@@ -0,0 +1,179 @@
+#if defined(__linux__)
+#include "encode_jpeg.hpp"
+#include <jpeglib.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "JpegErrorManager.hpp"
+
+namespace wcam::internal {
+
+namespace {
+/// Where to read the samples of one of the Y, Cb and Cr components
+struct SamplesPlane {
+    uint8_t const* data;
+    size_t         bytes_per_row;
+    size_t         step; // The distance between two consecutive samples, for planes that are interleaved with other ones (e.g. YUYV)
+};
+
+/// The memory used by write_yuv(). It must be owned by encode_jpeg(), because no object with a destructor can be alive while libjpeg might jump out on an error (see JpegErrorManager).
+struct YuvRows {
+    std::array<std::vector<JSAMPROW>, 3> rows{};
+    std::array<std::vector<uint8_t>, 3>  scratch{};
+};
+} // namespace
+
+static auto row_in_memory(uint32_t row, uint32_t rows_count, FirstRowIs row_order) -> uint32_t
+{
+    return row_order == FirstRowIs::Top ? row : rows_count - 1 - row;
+}
+
+/// `chroma_vertical_subsampling` is 2 for 4:2:0 formats and 1 for 4:2:2 formats. Chroma is always subsampled horizontally by 2.
+static void write_yuv(jpeg_compress_struct& info, std::array<SamplesPlane, 3> const& planes, uint32_t chroma_vertical_subsampling, Resolution resolution, FirstRowIs row_order, YuvRows& yuv_rows)
+{
+    info.raw_data_in                = TRUE;
+    info.comp_info[0].h_samp_factor = 2;
+    info.comp_info[0].v_samp_factor = static_cast<int>(chroma_vertical_subsampling);
+    for (size_t i = 1; i < 3; ++i)
+    {
+        info.comp_info[i].h_samp_factor = 1; // NOLINT(*pointer-arithmetic)
+        info.comp_info[i].v_samp_factor = 1; // NOLINT(*pointer-arithmetic)
+    }
+    jpeg_start_compress(&info, TRUE);
+
+    // libjpeg reads whole blocks, so each row must be padded to a multiple of the block width, and each call must give it a whole row of blocks.
+    // When a plane is already laid out like that we give libjpeg pointers to its rows, otherwise we copy the rows and pad them by repeating their last sample.
+    auto const luma_rows_per_call = static_cast<size_t>(DCTSIZE) * chroma_vertical_subsampling;
+    auto&      rows               = yuv_rows.rows;
+    auto&      scratch            = yuv_rows.scratch;
+    for (size_t c = 0; c < 3; ++c)
+    {
+        auto const width        = c == 0 ? static_cast<size_t>(resolution.width()) : static_cast<size_t>(resolution.width()) / 2;
+        auto const padded_width = (width + DCTSIZE - 1) / DCTSIZE * DCTSIZE;
+        auto const rows_count   = c == 0 ? luma_rows_per_call : static_cast<size_t>(DCTSIZE);
+        rows[c].resize(rows_count);                       // NOLINT(*constant-array-index)
+        if (planes[c].step != 1 || padded_width != width) // NOLINT(*constant-array-index)
+            scratch[c].resize(padded_width * rows_count); // NOLINT(*constant-array-index)
+    }
+
+    while (info.next_scanline < info.image_height)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            auto const  subsampling = c == 0 ? 1 : chroma_vertical_subsampling;
+            auto const  width       = c == 0 ? resolution.width() : resolution.width() / 2;
+            auto const  rows_count  = (resolution.height() + subsampling - 1) / subsampling;
+            auto const  first_row   = info.next_scanline / subsampling;
+            auto const& plane       = planes[c];  // NOLINT(*constant-array-index)
+            auto&       plane_rows  = rows[c];    // NOLINT(*constant-array-index)
+            auto&       buffer      = scratch[c]; // NOLINT(*constant-array-index)
+            auto const  padded_size = buffer.size() / plane_rows.size();
+            for (size_t i = 0; i < plane_rows.size(); ++i)
+            {
+                auto const  row = std::min(first_row + static_cast<uint32_t>(i), rows_count - 1);              // Repeat the last row when the height is not a multiple of the block height
+                auto const* src = plane.data + row_in_memory(row, rows_count, row_order) * plane.bytes_per_row; // NOLINT(*pointer-arithmetic)
+                if (buffer.empty())
+                {
+                    plane_rows[i] = const_cast<JSAMPROW>(src); // NOLINT(*const-cast) libjpeg doesn't write to the rows
+                    continue;
+                }
+                auto* const dst = buffer.data() + i * padded_size; // NOLINT(*pointer-arithmetic)
+                for (size_t x = 0; x < width; ++x)
+                    dst[x] = src[x * plane.step];                          // NOLINT(*pointer-arithmetic)
+                std::fill(dst + width, dst + padded_size, dst[width - 1]); // NOLINT(*pointer-arithmetic)
+                plane_rows[i] = dst;
+            }
+        }
+        auto arrays = std::array<JSAMPARRAY, 3>{rows[0].data(), rows[1].data(), rows[2].data()};
+        jpeg_write_raw_data(&info, arrays.data(), static_cast<JDIMENSION>(luma_rows_per_call));
+    }
+}
+
+static void write_scanlines(jpeg_compress_struct& info, uint8_t const* data, size_t bytes_per_row, Resolution resolution, FirstRowIs row_order)
+{
+    jpeg_start_compress(&info, TRUE);
+    while (info.next_scanline < info.image_height)
+    {
+        auto row = const_cast<JSAMPROW>(data + row_in_memory(info.next_scanline, resolution.height(), row_order) * bytes_per_row); // NOLINT(*const-cast, *pointer-arithmetic) libjpeg doesn't write to the rows
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+}
+
+auto encode_jpeg(HistoryFrame const& frame, int quality, std::FILE* file) -> std::optional<std::string>
+{
+    auto const  resolution = frame.resolution;
+    auto const* data       = frame.data.get();
+    auto const  width      = static_cast<size_t>(resolution.width());
+
+    struct jpeg_compress_struct info; // NOLINT(*member-init)
+    auto                        error_manager = JpegErrorManager{};
+
+    info.err = error_manager.install();
+    jpeg_create_compress(&info);
+    info.image_width  = resolution.width();
+    info.image_height = resolution.height();
+
+    switch (frame.format)
+    {
+    case HistoryFrameFormat::YUYV:
+    case HistoryFrameFormat::NV12:
+    case HistoryFrameFormat::I420:
+        info.input_components = 3;
+        info.in_color_space   = JCS_YCbCr;
+        break;
+    case HistoryFrameFormat::BGR24:
+        info.input_components = 3;
+        info.in_color_space   = JCS_EXT_BGR;
+        break;
+    case HistoryFrameFormat::GRAY8:
+        info.input_components = 1;
+        info.in_color_space   = JCS_GRAYSCALE;
+        break;
+    default:
+        jpeg_destroy_compress(&info);
+        return "Snapshots are not supported for this pixel format yet";
+    }
+
+    auto       yuv_rows = YuvRows{};
+    bool const success  = error_manager.catch_jpeg_errors([&]() {
+        jpeg_stdio_dest(&info, file);
+        jpeg_set_defaults(&info);
+        jpeg_set_quality(&info, std::clamp(quality, 1, 100), TRUE);
+
+        switch (frame.format)
+        {
+        case HistoryFrameFormat::YUYV:
+        {
+            auto const bytes_per_row = frame.data_size / resolution.height(); // Handles the padding that some drivers add at the end of the rows
+            write_yuv(info, {SamplesPlane{data, bytes_per_row, 2}, SamplesPlane{data + 1, bytes_per_row, 4}, SamplesPlane{data + 3, bytes_per_row, 4}}, 1, resolution, frame.row_order, yuv_rows); // NOLINT(*pointer-arithmetic)
+            break;
+        }
+        case HistoryFrameFormat::NV12:
+        {
+            auto const* chroma = data + resolution.pixels_count(); // NOLINT(*pointer-arithmetic)
+            write_yuv(info, {SamplesPlane{data, width, 1}, SamplesPlane{chroma, width, 2}, SamplesPlane{chroma + 1, width, 2}}, 2, resolution, frame.row_order, yuv_rows); // NOLINT(*pointer-arithmetic)
+            break;
+        }
+        case HistoryFrameFormat::I420:
+        {
+            auto const* u = data + resolution.pixels_count();  // NOLINT(*pointer-arithmetic)
+            auto const* v = u + resolution.pixels_count() / 4; // NOLINT(*pointer-arithmetic)
+            write_yuv(info, {SamplesPlane{data, width, 1}, SamplesPlane{u, width / 2, 1}, SamplesPlane{v, width / 2, 1}}, 2, resolution, frame.row_order, yuv_rows);
+            break;
+        }
+        default: // BGR24 and GRAY8
+            write_scanlines(info, data, frame.data_size / resolution.height(), resolution, frame.row_order);
+            break;
+        }
+
+        jpeg_finish_compress(&info);
+    });
+    jpeg_destroy_compress(&info);
+    if (!success)
+        return error_manager.message(); // e.g. the disk is full
+    return std::nullopt;
+}
+
+} // namespace wcam::internal
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+#if defined(__linux__)
+#include <cstdio>
+#include <optional>
+#include <string>
+#include "../History.hpp"
+
+namespace wcam::internal {
+
+/// Encodes the frame and writes it to `file`. Returns an error message if the format is not supported.
+/// YUV frames are given to libjpeg as is, without converting them to RGB, because JPEG stores YUV anyways.
+auto encode_jpeg(HistoryFrame const&, int quality, std::FILE* file) -> std::optional<std::string>;
+
+} // namespace wcam::internal
+
+#endif
@@ -0,0 +1,107 @@
+#include "grayscale.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "BufferPool.hpp"
+#include "unpack_raw10.hpp"
+
+namespace wcam::internal {
+
+auto is_gray_format(HistoryFrameFormat format) -> bool
+{
+    return format == HistoryFrameFormat::GRAY8
+           || format == HistoryFrameFormat::GRAY16
+           || format == HistoryFrameFormat::GRAY10
+           || format == HistoryFrameFormat::GRAY10P;
+}
+
+/// Removes the padding at the end of the rows
+static auto copy_rows(uint8_t const* data, size_t bytes_per_line, size_t row_size, uint32_t rows_count) -> PooledBuffer
+{
+    auto buffer = buffer_pool().acquire(row_size * rows_count);
+    for (uint32_t y = 0; y < rows_count; ++y)
+        std::memcpy(buffer.data() + y * row_size, data + y * bytes_per_line, row_size); // NOLINT(*pointer-arithmetic)
+    return buffer;
+}
+
+template<typename PixelFormatT>
+static void set_data_without_padding(Image& image, uint8_t const* data, size_t bytes_per_line, Resolution resolution, FirstRowIs row_order, size_t bytes_per_pixel)
+{
+    auto const row_size = static_cast<size_t>(resolution.width()) * bytes_per_pixel;
+    if (bytes_per_line == row_size)
+    {
+        image.set_data(ImageDataView<PixelFormatT>{data, PixelFormatT::data_length(resolution), resolution, row_order}); // Zero-copy
+        return;
+    }
+    auto const buffer = copy_rows(data, bytes_per_line, row_size, resolution.height());
+    image.set_data(ImageDataView<PixelFormatT>{buffer.shared_data(), buffer.size(), resolution, row_order});
+}
+
+static auto row_size(HistoryFrameFormat format, Resolution resolution) -> size_t
+{
+    auto const width = static_cast<size_t>(resolution.width());
+    switch (format)
+    {
+    case HistoryFrameFormat::GRAY16:
+    case HistoryFrameFormat::GRAY10:
+        return width * 2;
+    case HistoryFrameFormat::GRAY10P:
+        return width * 5 / 4;
+    default:
+        return width;
+    }
+}
+
+auto set_gray_data(Image& image, uint8_t const* data, size_t data_size, size_t bytes_per_line, Resolution resolution, FirstRowIs row_order, HistoryFrameFormat format) -> bool
+{
+    bytes_per_line = std::max(bytes_per_line, row_size(format, resolution)); // Some drivers leave bytesperline to 0 when the rows are not padded
+    if (data_size < bytes_per_line * resolution.height())
+        return false;
+
+    switch (format)
+    {
+    case HistoryFrameFormat::GRAY8:
+    {
+        set_data_without_padding<GRAY8>(image, data, bytes_per_line, resolution, row_order, 1);
+        break;
+    }
+    case HistoryFrameFormat::GRAY16:
+    {
+        set_data_without_padding<GRAY16>(image, data, bytes_per_line, resolution, row_order, 2);
+        break;
+    }
+    case HistoryFrameFormat::GRAY10:
+    {
+        auto        buffer = buffer_pool().acquire(GRAY16::data_length(resolution));
+        auto* const out    = reinterpret_cast<uint16_t*>(buffer.data()); // NOLINT(*reinterpret-cast)
+        auto const  width  = static_cast<size_t>(resolution.width());
+        for (uint32_t y = 0; y < resolution.height(); ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                auto value = uint16_t{};
+                std::memcpy(&value, data + y * bytes_per_line + x * 2, sizeof(value)); // NOLINT(*pointer-arithmetic) The rows might not be aligned
+                value              = static_cast<uint16_t>(value & 0x3FF);
+                out[y * width + x] = static_cast<uint16_t>((value << 6) | (value >> 4)); // NOLINT(*pointer-arithmetic) Replicate the most significant bits, so that 1023 becomes 65535
+            }
+        }
+        image.set_data(ImageDataView<GRAY16>{buffer.shared_data(), buffer.size(), resolution, row_order});
+        break;
+    }
+    case HistoryFrameFormat::GRAY10P:
+    {
+        auto buffer = buffer_pool().acquire(GRAY16::data_length(resolution));
+        unpack_raw10_to_16bits(data, bytes_per_line, resolution, reinterpret_cast<uint16_t*>(buffer.data())); // NOLINT(*reinterpret-cast)
+        image.set_data(ImageDataView<GRAY16>{buffer.shared_data(), buffer.size(), resolution, row_order});
+        break;
+    }
+    default:
+    {
+        assert(false && "Not a grayscale format");
+        break;
+    }
+    }
+    return true;
+}
+
+} // namespace wcam::internal
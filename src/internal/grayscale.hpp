@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "../History.hpp"
+#include "../Image.hpp"
+
+namespace wcam::internal {
+
+[[nodiscard]] auto is_gray_format(HistoryFrameFormat) -> bool;
+
+/// Gives the frame to the image as GRAY8 or GRAY16. When the camera already uses that layout, the image gets a view of `data` directly, without any copy.
+/// 10-bit formats are scaled to use the whole 16-bit range.
+/// `bytes_per_line` is the distance between rows, as reported by the driver (it includes the padding that some drivers add at the end of the rows). 0 means that the rows are not padded.
+/// Returns false, and leaves the image untouched, if `data_size` is too small to contain all the rows (e.g. the frame was truncated).
+[[nodiscard]] auto set_gray_data(Image&, uint8_t const* data, size_t data_size, size_t bytes_per_line, Resolution, FirstRowIs, HistoryFrameFormat) -> bool;
+
+} // namespace wcam::internal
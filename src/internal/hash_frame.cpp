@@ -0,0 +1,88 @@
+#include "hash_frame.hpp"
+#include <array>
+#include <cstring>
+
+namespace wcam::internal {
+
+// Constants and rounds from xxHash64
+static constexpr uint64_t prime_1 = 11400714785074694791ULL;
+static constexpr uint64_t prime_2 = 14029467366897019727ULL;
+static constexpr uint64_t prime_3 = 1609587929392839161ULL;
+
+static auto rotate_left(uint64_t x, int bits) -> uint64_t
+{
+    return (x << bits) | (x >> (64 - bits));
+}
+
+static auto round(uint64_t accumulator, uint64_t input) -> uint64_t
+{
+    return rotate_left(accumulator + input * prime_2, 31) * prime_1;
+}
+
+static auto read_u64(uint8_t const* data) -> uint64_t
+{
+    uint64_t res; // NOLINT(*init-variables)
+    std::memcpy(&res, data, sizeof(res));
+    return res;
+}
+
+class Hasher {
+public:
+    /// `data` must contain a multiple of 32 bytes.
+    /// We use 4 independent lanes so that the compiler can process them in parallel (using SIMD and / or instruction-level parallelism).
+    void add_blocks(uint8_t const* data, size_t size)
+    {
+        for (size_t i = 0; i + 32 <= size; i += 32)
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+                _lanes[lane] = round(_lanes[lane], read_u64(data + i + lane * 8)); // NOLINT(*pointer-arithmetic, *constant-array-index)
+        }
+    }
+
+    void add_tail(uint8_t const* data, size_t size)
+    {
+        auto block = std::array<uint8_t, 32>{};
+        std::memcpy(block.data(), data, size);
+        add_blocks(block.data(), block.size());
+    }
+
+    [[nodiscard]] auto result(uint64_t data_size) const -> uint64_t
+    {
+        uint64_t hash = rotate_left(_lanes[0], 1) + rotate_left(_lanes[1], 7) + rotate_left(_lanes[2], 12) + rotate_left(_lanes[3], 18);
+        hash ^= data_size;
+        hash ^= hash >> 33;
+        hash *= prime_2;
+        hash ^= hash >> 29;
+        hash *= prime_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    std::array<uint64_t, 4> _lanes{prime_1 + prime_2, prime_2, 0, 0 - prime_1};
+};
+
+auto hash_frame(uint8_t const* data, size_t size) -> uint64_t
+{
+    auto       hasher      = Hasher{};
+    auto const blocks_size = size - size % 32;
+    hasher.add_blocks(data, blocks_size);
+    hasher.add_tail(data + blocks_size, size - blocks_size); // NOLINT(*pointer-arithmetic)
+    return hasher.result(size);
+}
+
+auto hash_frame_sampled(uint8_t const* data, size_t size) -> uint64_t
+{
+    static constexpr size_t samples_count = 1024;
+    static constexpr size_t sample_size   = 64;
+    if (size <= samples_count * sample_size * 2) // Sampling wouldn't save much
+        return hash_frame(data, size);
+
+    auto       hasher = Hasher{};
+    auto const stride = size / samples_count;
+    for (size_t i = 0; i < samples_count; ++i)
+        hasher.add_blocks(data + i * stride, sample_size); // NOLINT(*pointer-arithmetic)
+    return hasher.result(size);
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace wcam::internal {
+
+/// Fast, non-cryptographic hash of the raw data of a frame. Meant to detect identical frames.
+auto hash_frame(uint8_t const* data, size_t size) -> uint64_t;
+
+/// Only hashes a few blocks evenly spread through the data. A lot cheaper on big frames, but will miss changes that happen outside of those blocks.
+auto hash_frame_sampled(uint8_t const* data, size_t size) -> uint64_t;
+
+} // namespace wcam::internal
@@ -0,0 +1,90 @@
+#if defined(__linux__)
+#include "mjpeg.hpp"
+#include <jpeglib.h>
+#include <vector>
+#include "BufferPool.hpp"
+#include "JpegErrorManager.hpp"
+
+namespace wcam::internal {
+
+auto mjpeg_to_rgb(uint8_t const* data, size_t size, unsigned int scale_denominator, RowsDecodedCallback const& on_rows_decoded, uint32_t rows_per_slice) -> std::optional<DecodedImage>
+{
+    struct jpeg_decompress_struct info; // NOLINT(*member-init)
+    auto                          error_manager = JpegErrorManager{};
+
+    info.err = error_manager.install();
+    jpeg_create_decompress(&info);
+
+    auto       rgb_data = std::shared_ptr<uint8_t>{}; // Created outside of catch_jpeg_errors(), see JpegErrorManager
+    auto       image    = DecodedImage{};
+    bool const success  = error_manager.catch_jpeg_errors([&]() {
+        jpeg_mem_src(&info, data, size);
+        jpeg_read_header(&info, TRUE);
+        info.out_color_space = JCS_RGB;
+        info.scale_num       = 1;
+        info.scale_denom     = scale_denominator;
+        jpeg_start_decompress(&info);
+
+        auto const resolution = Resolution{static_cast<Resolution::DataType>(info.output_width), static_cast<Resolution::DataType>(info.output_height)};
+        rgb_data              = buffer_pool().acquire(resolution.pixels_count() * 3).shared_data();
+        image                 = DecodedImage{rgb_data, resolution};
+        uint32_t first_row    = 0; // The first row that has not been notified yet
+        while (info.output_scanline < info.output_height)
+        {
+            unsigned char* buffer_array = rgb_data.get() + static_cast<uint64_t>(info.output_scanline) * static_cast<uint64_t>(info.output_width) * 3; // NOLINT(*pointer-arithmetic)
+            jpeg_read_scanlines(&info, &buffer_array, 1);
+            if (on_rows_decoded
+                && (info.output_scanline - first_row >= rows_per_slice || info.output_scanline == info.output_height))
+            {
+                on_rows_decoded(image, first_row, info.output_scanline - first_row);
+                first_row = info.output_scanline;
+            }
+        }
+
+        jpeg_finish_decompress(&info);
+    });
+    jpeg_destroy_decompress(&info);
+    if (!success)
+        return std::nullopt;
+    return image;
+}
+
+auto mjpeg_luma_grid(uint8_t const* data, size_t size) -> std::optional<LumaGrid>
+{
+    struct jpeg_decompress_struct info; // NOLINT(*member-init)
+    auto                          error_manager = JpegErrorManager{};
+
+    info.err = error_manager.install();
+    jpeg_create_decompress(&info);
+
+    auto       resolution = Resolution{};
+    auto       luma       = std::vector<uint8_t>{}; // Created outside of catch_jpeg_errors(), see JpegErrorManager
+    bool const success    = error_manager.catch_jpeg_errors([&]() {
+        jpeg_mem_src(&info, data, size);
+        jpeg_read_header(&info, TRUE);
+        info.out_color_space = JCS_GRAYSCALE;
+        info.scale_num       = 1;
+        info.scale_denom     = 8;
+        jpeg_start_decompress(&info);
+
+        resolution = Resolution{static_cast<Resolution::DataType>(info.output_width), static_cast<Resolution::DataType>(info.output_height)};
+        luma.resize(resolution.pixels_count());
+        while (info.output_scanline < info.output_height)
+        {
+            unsigned char* buffer_array = luma.data() + static_cast<uint64_t>(info.output_scanline) * static_cast<uint64_t>(info.output_width); // NOLINT(*pointer-arithmetic)
+            jpeg_read_scanlines(&info, &buffer_array, 1);
+        }
+
+        jpeg_finish_decompress(&info);
+    });
+    jpeg_destroy_decompress(&info);
+    if (!success)
+        return std::nullopt;
+    return LumaGrid{resolution, [&](uint32_t x, uint32_t y) {
+                        return static_cast<uint32_t>(luma[static_cast<size_t>(x) + static_cast<size_t>(y) * resolution.width()]);
+                    }};
+}
+
+} // namespace wcam::internal
+
+#endif
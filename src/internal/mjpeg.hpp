@@ -0,0 +1,32 @@
+#pragma once
+#if defined(__linux__)
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include "../Resolution.hpp"
+#include "MotionGate.hpp"
+
+namespace wcam::internal {
+
+struct DecodedImage {
+    std::shared_ptr<uint8_t const> rgb_data;
+    Resolution                     resolution;
+};
+
+/// Called while decoding, each time some rows of the image are ready
+using RowsDecodedCallback = std::function<void(DecodedImage const&, uint32_t first_row, uint32_t rows_count)>;
+
+/// `scale_denominator` allows us to decode at 1/2, 1/4 or 1/8 of the resolution, which is a lot cheaper
+/// If `on_rows_decoded` is set, it is called each time `rows_per_slice` rows are ready, and once more for the remaining rows at the end
+/// Returns std::nullopt if the frame is corrupted.
+auto mjpeg_to_rgb(uint8_t const* data, size_t size, unsigned int scale_denominator, RowsDecodedCallback const& on_rows_decoded = {}, uint32_t rows_per_slice = 0) -> std::optional<DecodedImage>;
+
+/// Decodes the JPEG at 1/8 of its resolution and only its luminance, which is a lot cheaper than a full decode
+/// Returns std::nullopt if the frame is corrupted.
+auto mjpeg_luma_grid(uint8_t const* data, size_t size) -> std::optional<LumaGrid>;
+
+} // namespace wcam::internal
+
+#endif
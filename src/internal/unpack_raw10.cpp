@@ -0,0 +1,47 @@
+#include "unpack_raw10.hpp"
+
+namespace wcam::internal {
+
+void unpack_raw10_to_8bits(uint8_t const* packed, size_t bytes_per_line, Resolution resolution, uint8_t* out)
+{
+    auto const width = static_cast<size_t>(resolution.width());
+    for (uint32_t y = 0; y < resolution.height(); ++y)
+    {
+        auto const* in_row  = packed + y * bytes_per_line; // NOLINT(*pointer-arithmetic)
+        auto*       out_row = out + y * width;             // NOLINT(*pointer-arithmetic)
+        for (size_t group = 0; group < width / 4; ++group)
+        {
+            out_row[group * 4 + 0] = in_row[group * 5 + 0]; // NOLINT(*pointer-arithmetic)
+            out_row[group * 4 + 1] = in_row[group * 5 + 1]; // NOLINT(*pointer-arithmetic)
+            out_row[group * 4 + 2] = in_row[group * 5 + 2]; // NOLINT(*pointer-arithmetic)
+            out_row[group * 4 + 3] = in_row[group * 5 + 3]; // NOLINT(*pointer-arithmetic)
+        }
+        for (size_t x = width / 4 * 4; x < width; ++x) // The last group might be incomplete
+            out_row[x] = in_row[x / 4 * 5 + x % 4];    // NOLINT(*pointer-arithmetic)
+    }
+}
+
+void unpack_raw10_to_16bits(uint8_t const* packed, size_t bytes_per_line, Resolution resolution, uint16_t* out)
+{
+    auto const width  = static_cast<size_t>(resolution.width());
+    auto const to_u16 = [](uint8_t const* group, size_t i) { // The i-th pixel of a group of 4
+        auto const value = static_cast<uint32_t>(group[i] << 2) | ((static_cast<uint32_t>(group[4]) >> (2 * i)) & 0b11); // NOLINT(*pointer-arithmetic)
+        return static_cast<uint16_t>((value << 6) | (value >> 4));                                                       // Replicate the most significant bits, so that 1023 becomes 65535
+    };
+    for (uint32_t y = 0; y < resolution.height(); ++y)
+    {
+        auto const* in_row  = packed + y * bytes_per_line; // NOLINT(*pointer-arithmetic)
+        auto*       out_row = out + y * width;             // NOLINT(*pointer-arithmetic)
+        for (size_t group = 0; group < width / 4; ++group)
+        {
+            out_row[group * 4 + 0] = to_u16(in_row + group * 5, 0); // NOLINT(*pointer-arithmetic)
+            out_row[group * 4 + 1] = to_u16(in_row + group * 5, 1); // NOLINT(*pointer-arithmetic)
+            out_row[group * 4 + 2] = to_u16(in_row + group * 5, 2); // NOLINT(*pointer-arithmetic)
+            out_row[group * 4 + 3] = to_u16(in_row + group * 5, 3); // NOLINT(*pointer-arithmetic)
+        }
+        for (size_t x = width / 4 * 4; x < width; ++x)      // The last group might be incomplete
+            out_row[x] = to_u16(in_row + x / 4 * 5, x % 4); // NOLINT(*pointer-arithmetic)
+    }
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "../Resolution.hpp"
+
+// MIPI CSI-2 RAW10 packs 4 pixels in 5 bytes: the 8 most significant bits of each of the 4 pixels, and then one byte with their 2 least significant bits.
+// In both functions, the rows are `bytes_per_line` apart in `packed` (drivers sometimes add some padding), and `out` is tightly packed.
+
+namespace wcam::internal {
+
+/// Only keeps the 8 most significant bits of each pixel, which is just a copy of 4 bytes out of 5
+void unpack_raw10_to_8bits(uint8_t const* packed, size_t bytes_per_line, Resolution, uint8_t* out);
+
+/// Keeps the full precision, scaled to use the whole 16-bit range
+void unpack_raw10_to_16bits(uint8_t const* packed, size_t bytes_per_line, Resolution, uint16_t* out);
+
+} // namespace wcam::internal
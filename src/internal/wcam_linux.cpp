@@ -2,18 +2,35 @@
 #include "wcam_linux.hpp"
 #include <fcntl.h>
 #include <fmt/format.h>
-#include <jpeglib.h>
 #include <linux/videodev2.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <functional>
+#include <optional>
 #include <source_location/source_location.hpp>
+#include <vector>
+#include "../BayerSettings.hpp"
+#include "../HardwareTimestampsSettings.hpp"
 #include "../Info.hpp"
+#include "../LatencySettings.hpp"
 #include "Cool/get_system_error.hpp"
-#include "ImageFactory.hpp"
+#include "DeviceSettingsManager.hpp"
+#include "BufferPool.hpp"
+#include "ThreadSettingsManager.hpp"
+#include "UsbBandwidthBudget.hpp"
+#include "UvcMetadataStream.hpp"
+#include "demosaic.hpp"
 #include "fallback_webcam_name.hpp"
+#include "grayscale.hpp"
 #include "make_device_id.hpp"
+#include "mjpeg.hpp"
+#include "yuyv_to_rgb.hpp"
 
 namespace wcam::internal {
 
@@ -59,24 +76,37 @@ static auto webcam_id(std::filesystem::path const& webcam_path) -> DeviceId
     return make_device_id(webcam_path.filename());
 }
 
-static auto find_webcam_name(int webcam_handle) -> std::string
+/// Devices that only implement the multi-planar API (e.g. many HDMI capture cards and the ISPs of SoCs) need another buffer type in all the ioctls.
+/// Returns std::nullopt if the device can't capture video at all.
+static auto capture_buffer_type(int webcam_handle) -> std::optional<v4l2_buf_type>
 {
     auto cap = v4l2_capability{};
     if (ioctl(webcam_handle, VIDIOC_QUERYCAP, &cap) == -1)
-        return fallback_webcam_name();
+        return std::nullopt;
+
+    auto const capabilities = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities; // `capabilities` describes the whole physical device, `device_caps` only the node that we opened
+    if (capabilities & V4L2_CAP_VIDEO_CAPTURE)
+        return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
+        return V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    return std::nullopt;
+}
 
-    if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE))
+static auto find_webcam_name(int webcam_handle) -> std::string
+{
+    auto cap = v4l2_capability{};
+    if (ioctl(webcam_handle, VIDIOC_QUERYCAP, &cap) == -1)
         return fallback_webcam_name();
 
     return reinterpret_cast<const char*>(cap.card); // NOLINT(*-pro-type-reinterpret-cast)
 }
 
-static auto find_resolutions(int webcam_handle) -> std::vector<Resolution>
+static auto find_resolutions(int webcam_handle, v4l2_buf_type buffer_type) -> std::vector<Resolution>
 {
     auto resolutions = std::vector<Resolution>{};
 
     auto format_description = v4l2_fmtdesc{};
-    format_description.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format_description.type = buffer_type;
     for (; ioctl(webcam_handle, VIDIOC_ENUM_FMT, &format_description) == 0; format_description.index++)
     {
         auto frame_size         = v4l2_frmsizeenum{};
@@ -112,7 +142,10 @@ auto grab_all_infos_impl() -> std::vector<Info>
             return;
         auto const scope_guard = FileRAII{webcam_handle};
 
-        auto const resolutions = find_resolutions(webcam_handle);
+        auto const buffer_type = capture_buffer_type(webcam_handle);
+        if (!buffer_type)
+            return;
+        auto const resolutions = find_resolutions(webcam_handle, *buffer_type);
         if (resolutions.empty())
             return;
 
@@ -126,163 +159,808 @@ auto grab_all_infos_impl() -> std::vector<Info>
 static auto is_supported_pixel_format(uint32_t format) -> bool
 {
     return format == V4L2_PIX_FMT_MJPEG
-           || format == V4L2_PIX_FMT_YUYV;
+           || format == V4L2_PIX_FMT_YUYV
+           || format == V4L2_PIX_FMT_NV12
+           || format == V4L2_PIX_FMT_NV12M
+           || format == V4L2_PIX_FMT_YUV420
+           || format == V4L2_PIX_FMT_YUV420M
+           || format == V4L2_PIX_FMT_SRGGB8
+           || format == V4L2_PIX_FMT_SBGGR8
+           || format == V4L2_PIX_FMT_SGRBG8
+           || format == V4L2_PIX_FMT_SGBRG8
+           || format == V4L2_PIX_FMT_SRGGB10P
+           || format == V4L2_PIX_FMT_SBGGR10P
+           || format == V4L2_PIX_FMT_SGRBG10P
+           || format == V4L2_PIX_FMT_SGBRG10P
+           || format == V4L2_PIX_FMT_GREY
+           || format == V4L2_PIX_FMT_Y10
+           || format == V4L2_PIX_FMT_Y10P
+           || format == V4L2_PIX_FMT_Y16
+           || format == V4L2_PIX_FMT_Z16;
 }
 
-static auto select_pixel_format(int webcam_handle, Resolution resolution) -> uint32_t
+/// How we store the raw frames in the history (and in stills and bursts). Must only be called with a supported format.
+static auto history_format(uint32_t pixel_format) -> HistoryFrameFormat
 {
-    auto format_desc = v4l2_fmtdesc{};
-    format_desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    switch (pixel_format)
+    {
+    case V4L2_PIX_FMT_MJPEG:
+        return HistoryFrameFormat::MJPEG;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV12M: // We store the planes one after the other, so this is the same as NV12
+        return HistoryFrameFormat::NV12;
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_YUV420M:
+        return HistoryFrameFormat::I420;
+    case V4L2_PIX_FMT_SRGGB8:
+        return HistoryFrameFormat::BayerRGGB8;
+    case V4L2_PIX_FMT_SBGGR8:
+        return HistoryFrameFormat::BayerBGGR8;
+    case V4L2_PIX_FMT_SGRBG8:
+        return HistoryFrameFormat::BayerGRBG8;
+    case V4L2_PIX_FMT_SGBRG8:
+        return HistoryFrameFormat::BayerGBRG8;
+    case V4L2_PIX_FMT_SRGGB10P:
+        return HistoryFrameFormat::BayerRGGB10P;
+    case V4L2_PIX_FMT_SBGGR10P:
+        return HistoryFrameFormat::BayerBGGR10P;
+    case V4L2_PIX_FMT_SGRBG10P:
+        return HistoryFrameFormat::BayerGRBG10P;
+    case V4L2_PIX_FMT_SGBRG10P:
+        return HistoryFrameFormat::BayerGBRG10P;
+    case V4L2_PIX_FMT_GREY:
+        return HistoryFrameFormat::GRAY8;
+    case V4L2_PIX_FMT_Y10:
+        return HistoryFrameFormat::GRAY10;
+    case V4L2_PIX_FMT_Y10P:
+        return HistoryFrameFormat::GRAY10P;
+    case V4L2_PIX_FMT_Y16:
+    case V4L2_PIX_FMT_Z16: // Depth cameras give the distance in millimeters, we expose it as-is
+        return HistoryFrameFormat::GRAY16;
+    default:
+        assert(pixel_format == V4L2_PIX_FMT_YUYV);
+        return HistoryFrameFormat::YUYV;
+    }
+}
 
-    for (format_desc.index = 0; ioctl(webcam_handle, VIDIOC_ENUM_FMT, &format_desc) == 0; format_desc.index++)
+struct CaptureMode {
+    uint32_t   pixel_format{};
+    v4l2_fract frame_interval{}; // In seconds per frame
+};
+
+static auto frames_per_second(v4l2_fract frame_interval) -> double
+{
+    return static_cast<double>(frame_interval.denominator) / static_cast<double>(std::max(frame_interval.numerator, 1u));
+}
+
+/// Without the padding that some drivers add at the end of the rows
+static auto bytes_per_frame(HistoryFrameFormat format, Resolution resolution) -> uint64_t
+{
+    auto const pixels_count = static_cast<uint64_t>(resolution.pixels_count());
+    switch (format)
     {
-        auto frame_size         = v4l2_frmsizeenum{};
-        frame_size.pixel_format = format_desc.pixelformat;
+    case HistoryFrameFormat::MJPEG:
+        return pixels_count * 2 / 6; // MJPEG frames are usually 5 to 10 times smaller than the corresponding YUYV ones, we stay on the conservative side
+    case HistoryFrameFormat::YUYV:
+    case HistoryFrameFormat::GRAY16:
+    case HistoryFrameFormat::GRAY10: // Each pixel is stored on 16 bits
+        return pixels_count * 2;
+    case HistoryFrameFormat::BGR24:
+        return pixels_count * 3;
+    case HistoryFrameFormat::NV12:
+    case HistoryFrameFormat::I420:
+        return pixels_count * 3 / 2;
+    case HistoryFrameFormat::BayerRGGB8:
+    case HistoryFrameFormat::BayerBGGR8:
+    case HistoryFrameFormat::BayerGRBG8:
+    case HistoryFrameFormat::BayerGBRG8:
+    case HistoryFrameFormat::GRAY8:
+        return pixels_count;
+    case HistoryFrameFormat::BayerRGGB10P:
+    case HistoryFrameFormat::BayerBGGR10P:
+    case HistoryFrameFormat::BayerGRBG10P:
+    case HistoryFrameFormat::BayerGBRG10P:
+    case HistoryFrameFormat::GRAY10P:
+        return pixels_count * 5 / 4; // 4 pixels in 5 bytes
+    }
+    return pixels_count * 2;
+}
+
+/// Rough estimation of the bandwidth that the stream will use on the USB bus, in bytes per second
+static auto estimated_bandwidth(CaptureMode const& mode, Resolution resolution) -> uint64_t
+{
+    return static_cast<uint64_t>(static_cast<double>(bytes_per_frame(history_format(mode.pixel_format), resolution)) * frames_per_second(mode.frame_interval));
+}
+
+struct UsbBus {
+    std::string id{};        // The bus number, as given by sysfs
+    uint64_t    capacity{0}; // In bytes per second, the bandwidth that can be used by isochronous transfers on that bus
+};
+
+static auto read_first_line(std::filesystem::path const& path) -> std::optional<std::string>
+{
+    auto file = std::ifstream{path};
+    auto line = std::string{};
+    if (!std::getline(file, line))
+        return std::nullopt;
+    return line;
+}
+
+/// Returns std::nullopt if the camera is not a USB device (e.g. a virtual camera), in which case we don't need to care about the bandwidth
+static auto find_usb_bus(DeviceId const& id) -> std::optional<UsbBus>
+{
+    try
+    {
+        auto const video_node = std::filesystem::canonical(webcam_path(id)).filename(); // e.g. "video0"
+        // sysfs links the video node to the USB interface of the camera. We walk up from there until we find the USB device, which knows its bus number and speed.
+        for (auto path = std::filesystem::canonical(std::filesystem::path{"/sys/class/video4linux"} / video_node / "device");
+             path.has_relative_path();
+             path = path.parent_path())
+        {
+            auto const bus_number = read_first_line(path / "busnum");
+            auto const speed      = read_first_line(path / "speed"); // In Mb/s
+            if (!bus_number || !speed)
+                continue;
+            auto const megabits_per_second = std::stod(*speed);
+            auto const periodic_ratio      = megabits_per_second <= 480. ? 0.8 : 0.9; // USB 2.0 allows at most 80% of each microframe to be used by periodic (isochronous and interrupt) transfers, USB 3.x allows 90%
+            return UsbBus{
+                .id       = *bus_number,
+                .capacity = static_cast<uint64_t>(megabits_per_second * 1'000'000. / 8. * periodic_ratio),
+            };
+        }
+    }
+    catch (std::exception const&)
+    {
+    }
+    return std::nullopt;
+}
 
-        for (frame_size.index = 0; ioctl(webcam_handle, VIDIOC_ENUM_FRAMESIZES, &frame_size) == 0; frame_size.index++)
+/// Selects the mode with the highest frame rate that fits in the USB bandwidth that is still available
+static auto select_capture_mode(int webcam_handle, v4l2_buf_type buffer_type, Resolution resolution, std::optional<UsbBus> const& usb_bus) -> CaptureMode
+{
+    auto modes = std::vector<CaptureMode>{};
+
+    auto format_desc = v4l2_fmtdesc{};
+    format_desc.type = buffer_type;
+    for (format_desc.index = 0; ioctl(webcam_handle, VIDIOC_ENUM_FMT, &format_desc) == 0; format_desc.index++)
+    {
+        if (!is_supported_pixel_format(format_desc.pixelformat))
+            continue;
+
+        auto frame_interval         = v4l2_frmivalenum{};
+        frame_interval.pixel_format = format_desc.pixelformat;
+        frame_interval.width        = resolution.width();
+        frame_interval.height       = resolution.height();
+        for (frame_interval.index = 0; ioctl(webcam_handle, VIDIOC_ENUM_FRAMEINTERVALS, &frame_interval) == 0; frame_interval.index++)
         {
-            if (frame_size.type == V4L2_FRMSIZE_TYPE_DISCRETE
-                && frame_size.discrete.width == resolution.width()
-                && frame_size.discrete.height == resolution.height()
-                && is_supported_pixel_format(format_desc.pixelformat))
-            {
-                return format_desc.pixelformat;
-            }
+            if (frame_interval.type != V4L2_FRMIVAL_TYPE_DISCRETE)
+                continue;
+            modes.push_back({format_desc.pixelformat, frame_interval.discrete});
         }
     }
-    throw CaptureException{Error_Unknown{"Unsupported pixel format"}};
+    if (modes.empty())
+        throw CaptureException{Error_Unknown{"Unsupported pixel format"}};
+
+    std::stable_sort(modes.begin(), modes.end(), [](CaptureMode const& a, CaptureMode const& b) { // stable_sort, to keep the order of preference of the driver between formats that have the same frame rate
+        return frames_per_second(a.frame_interval) > frames_per_second(b.frame_interval);
+    });
+    if (!usb_bus)
+        return modes[0];
+
+    auto const available_bandwidth = usb_bandwidth_budget().available_bandwidth(usb_bus->id, usb_bus->capacity);
+    for (auto const& mode : modes)
+    {
+        if (estimated_bandwidth(mode, resolution) <= available_bandwidth)
+            return mode;
+    }
+    auto const cheapest_mode = std::min_element(modes.begin(), modes.end(), [&](CaptureMode const& a, CaptureMode const& b) {
+        return estimated_bandwidth(a, resolution) < estimated_bandwidth(b, resolution);
+    });
+    throw CaptureException{Error_NotEnoughUsbBandwidth{
+        .required_bytes_per_second  = estimated_bandwidth(*cheapest_mode, resolution),
+        .available_bytes_per_second = available_bandwidth,
+    }};
 }
 
 Buffer::~Buffer()
 {
-    if (ptr != nullptr && ptr != MAP_FAILED)
+    unmap();
+}
+
+void Buffer::unmap()
+{
+    for (auto& plane : planes)
     {
-        if (munmap(ptr, size) == -1)
+        if (plane.ptr != nullptr && plane.ptr != MAP_FAILED)
         {
-            perror("Failed to unmap buffer");
-            assert(false);
+            if (munmap(plane.ptr, plane.size) == -1)
+            {
+                perror("Failed to unmap buffer");
+                assert(false);
+            }
         }
+        plane.ptr  = nullptr;
+        plane.size = 0;
     }
+    planes_count = 0;
+}
+
+auto Buffer::total_size() const -> size_t
+{
+    size_t size = 0;
+    for (size_t i = 0; i < planes_count; ++i)
+        size += planes[i].size; // NOLINT(*constant-array-index)
+    return size;
 }
 
-CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution)
-    : _webcam_handle{open(webcam_path(id).c_str(), O_RDWR)}
+CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions)
+    : ICaptureImpl{id, std::move(subscriptions)}
+    , _webcam_handle{open(webcam_path(id).c_str(), O_RDWR)}
     , _resolution{resolution}
 {
     if (_webcam_handle == -1)
         throw CaptureException{Error_WebcamUnplugged{}};
-    _pixel_format = select_pixel_format(_webcam_handle, resolution);
+    auto const buffer_type = capture_buffer_type(_webcam_handle);
+    if (!buffer_type)
+        throw CaptureException{Error_Unknown{"This device can't capture video"}};
+    _buffer_type = *buffer_type;
+    start_stream();
+    // Start the thread once all the buffers are ready
+    start_thread();
+}
+
+CaptureImpl::~CaptureImpl()
+{
+    stop_thread();
+    stop_stream();
+    for (auto& request : _burst_requests)
+        request.promise.set_value(Error_Unknown{"The capture was stopped before the burst could start"});
+}
+
+auto CaptureImpl::reconfigure(Resolution const& resolution) -> bool
+{
+    stop_thread();
+    clear_restart_request();
+    stop_stream(); // We keep the file open: closing and reopening the device is what takes most of the time on many drivers
+    _resolution = resolution;
+    start_stream();
+    start_thread();
+    return true;
+}
+
+void CaptureImpl::start_thread()
+{
+    _wants_to_stop_thread.store(false);
+    _thread = std::thread{&CaptureImpl::thread_job, std::ref(*this)};
+}
+
+void CaptureImpl::stop_thread()
+{
+    if (!_thread.joinable())
+        return;
+    _wants_to_stop_thread.store(true);
+    _thread.join();
+}
+
+void CaptureImpl::start_stream()
+{
+    auto const usb_bus             = find_usb_bus(id());
+    auto const mode                = select_capture_mode(_webcam_handle, _buffer_type, _resolution, usb_bus);
+    auto const bandwidth           = estimated_bandwidth(mode, _resolution);
+    auto const available_bandwidth = usb_bus ? usb_bandwidth_budget().available_bandwidth(usb_bus->id, usb_bus->capacity) : 0;
+    _pixel_format                  = mode.pixel_format;
+    _adaptive_quality.emplace(id(), _pixel_format == V4L2_PIX_FMT_MJPEG);
 
     {
-        auto format                = v4l2_format{};
-        format.type                = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        format.fmt.pix.width       = _resolution.width();
-        format.fmt.pix.height      = _resolution.height();
-        format.fmt.pix.pixelformat = _pixel_format;
-        format.fmt.pix.field       = V4L2_FIELD_NONE;
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_S_FMT, &format));
+        auto format     = v4l2_format{};
+        format.type     = _buffer_type;
+        _bytes_per_line = {};
+        if (is_multiplanar())
+        {
+            format.fmt.pix_mp.width       = _resolution.width();
+            format.fmt.pix_mp.height      = _resolution.height();
+            format.fmt.pix_mp.pixelformat = _pixel_format;
+            format.fmt.pix_mp.field       = V4L2_FIELD_NONE;
+            THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_S_FMT, &format));
+            for (size_t i = 0; i < std::min<size_t>(format.fmt.pix_mp.num_planes, VIDEO_MAX_PLANES); ++i)
+                _bytes_per_line[i] = format.fmt.pix_mp.plane_fmt[i].bytesperline; // NOLINT(*constant-array-index)
+        }
+        else
+        {
+            format.fmt.pix.width       = _resolution.width();
+            format.fmt.pix.height      = _resolution.height();
+            format.fmt.pix.pixelformat = _pixel_format;
+            format.fmt.pix.field       = V4L2_FIELD_NONE;
+            THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_S_FMT, &format));
+            _bytes_per_line[0] = format.fmt.pix.bytesperline;
+        }
     }
 
+    {
+        auto params                      = v4l2_streamparm{};
+        params.type                      = _buffer_type;
+        params.parm.capture.timeperframe = mode.frame_interval;
+        std::ignore                      = ioctl(_webcam_handle, VIDIOC_S_PARM, &params); // Some drivers don't allow us to choose the frame rate, in which case they will use their default one
+    }
+
+    if (usb_bus)
+        _usb_bandwidth_reservation = usb_bandwidth_budget().reserve(usb_bus->id, bandwidth);
+
     {
         auto req   = v4l2_requestbuffers{};
-        req.count  = static_cast<unsigned int>(_buffers.size());
-        req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.count  = static_cast<unsigned int>(std::clamp<size_t>(device_settings<LatencySettings>().settings(id()).buffers_count, 2, VIDEO_MAX_FRAME));
+        req.type   = _buffer_type;
         req.memory = V4L2_MEMORY_MMAP;
         THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_REQBUFS, &req));
+        _buffers = std::vector<Buffer>(req.count); // The driver might give us a different number of buffers than what we asked for
     }
 
     for (size_t i = 0; i < _buffers.size(); ++i)
     {
-        auto buf   = v4l2_buffer{};
-        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index  = static_cast<unsigned int>(i);
-
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QUERYBUF, &buf));
+        auto handle      = make_buffer_handle();
+        handle.buf.index = static_cast<unsigned int>(i);
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_QUERYBUF, handle));
 
-        _buffers[i].size = buf.length;                                                                                  // NOLINT(*constant-array-index)
-        _buffers[i].ptr  = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, _webcam_handle, buf.m.offset); // NOLINT(*constant-array-index)
-        THROW_IF(_buffers[i].ptr == MAP_FAILED);                                                                        // NOLINT(*constant-array-index)
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QBUF, &buf));
+        auto& buffer        = _buffers[i];                                                                  // NOLINT(*constant-array-index)
+        buffer.planes_count = is_multiplanar() ? std::min<size_t>(handle.buf.length, VIDEO_MAX_PLANES) : 1; // With the multi-planar API, the driver tells us the number of planes in `length`
+        for (size_t plane = 0; plane < buffer.planes_count; ++plane)
+        {
+            auto const length         = is_multiplanar() ? handle.planes[plane].length : handle.buf.length;                // NOLINT(*constant-array-index)
+            auto const offset         = is_multiplanar() ? handle.planes[plane].m.mem_offset : handle.buf.m.offset;        // NOLINT(*constant-array-index)
+            buffer.planes[plane].size = length;                                                                            // NOLINT(*constant-array-index)
+            buffer.planes[plane].ptr  = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, _webcam_handle, offset); // NOLINT(*constant-array-index)
+            THROW_IF(buffer.planes[plane].ptr == MAP_FAILED);                                                              // NOLINT(*constant-array-index)
+        }
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle));
     }
 
+    if (device_settings<HardwareTimestampsSettings>().settings(id()).enabled)
+        _uvc_metadata = UvcMetadataStream::open(webcam_path(id())); // Must be streaming before the first frame arrives, otherwise we would miss its metadata
+
     {
-        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_STREAMON, &type));
+        v4l2_buf_type type = _buffer_type;
+        if (ioctl(_webcam_handle, VIDIOC_STREAMON, &type) == -1)
+        {
+            if (errno == ENOSPC) // This is what the driver tells us when the USB controller doesn't have enough bandwidth left for our stream (e.g. because of other applications, or because our estimation was too optimistic)
+                throw CaptureException{Error_NotEnoughUsbBandwidth{.required_bytes_per_second = bandwidth, .available_bytes_per_second = available_bandwidth}};
+            throw_error(Cool::get_system_error(), "ioctl(_webcam_handle, VIDIOC_STREAMON, &type)");
+        }
+        _is_streaming = true;
     }
-
-    // Start the thread once all the buffers are ready
-    _thread = std::thread{&CaptureImpl::thread_job, std::ref(*this)};
 }
 
-CaptureImpl::~CaptureImpl()
+void CaptureImpl::stop_stream()
 {
-    _wants_to_stop_thread.store(true);
-    _thread.join();
-
-    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    if (ioctl(_webcam_handle, VIDIOC_STREAMOFF, &type) == -1)
+    if (_is_streaming)
     {
-        perror("Failed to stop capture");
-        assert(false);
+        v4l2_buf_type type = _buffer_type;
+        if (ioctl(_webcam_handle, VIDIOC_STREAMOFF, &type) == -1)
+        {
+            perror("Failed to stop capture");
+            assert(false);
+        }
+        _is_streaming = false;
     }
+    _uvc_metadata.reset();
+    _buffers.clear();
+
+    // Free the buffers of the driver, otherwise it won't let us change the format
+    auto req    = v4l2_requestbuffers{};
+    req.count   = 0;
+    req.type    = _buffer_type;
+    req.memory  = V4L2_MEMORY_MMAP;
+    std::ignore = ioctl(_webcam_handle, VIDIOC_REQBUFS, &req);
+
+    _usb_bandwidth_reservation = UsbBandwidthReservation{};
 }
 
 void CaptureImpl::thread_job(CaptureImpl& This)
 {
     while (!This._wants_to_stop_thread.load())
+    {
+        thread_settings_manager().apply_settings_if_they_changed(ThreadRole::Capture);
+        auto bursts = [&]() { // IIFE
+            std::scoped_lock lock{This._burst_requests_mutex};
+            return std::exchange(This._burst_requests, {});
+        }();
+        for (auto& burst : bursts)
+            burst.promise.set_value(This.capture_burst(burst.frames_count, std::move(burst.buffers)));
         This.process_next_image();
+    }
+}
+
+void CaptureImpl::start_burst(BurstRequest request)
+{
+    std::scoped_lock lock{_burst_requests_mutex};
+    _burst_requests.push_back(std::move(request));
 }
 
-static void mjpeg_to_rgb(Buffer const& buffer, unsigned char* rgb_data)
+auto CaptureImpl::make_buffer_handle() const -> BufferHandle
 {
-    struct jpeg_decompress_struct info; // NOLINT(*member-init)
-    struct jpeg_error_mgr         err;  // NOLINT(*member-init)
+    auto handle       = BufferHandle{};
+    handle.buf.type   = _buffer_type;
+    handle.buf.memory = V4L2_MEMORY_MMAP;
+    return handle;
+}
+
+auto CaptureImpl::buffer_ioctl(unsigned long request, BufferHandle& handle) const -> int
+{
+    if (is_multiplanar())
+    {
+        handle.buf.m.planes = handle.planes.data(); // Set it each time, because the handle might have been copied since the last call
+        handle.buf.length   = static_cast<uint32_t>(handle.planes.size());
+    }
+    return ioctl(_webcam_handle, request, &handle.buf);
+}
+
+auto CaptureImpl::bytes_used(BufferHandle const& handle, size_t plane) const -> size_t
+{
+    if (!is_multiplanar())
+        return handle.buf.bytesused;
+    auto const& plane_info = handle.planes[plane]; // NOLINT(*constant-array-index)
+    return plane_info.bytesused - std::min(plane_info.data_offset, plane_info.bytesused);
+}
+
+auto CaptureImpl::plane_data(BufferHandle const& handle, size_t plane) const -> uint8_t const*
+{
+    auto const* data = static_cast<uint8_t const*>(_buffers[handle.buf.index].planes[plane].ptr); // NOLINT(*constant-array-index)
+    return is_multiplanar() ? data + handle.planes[plane].data_offset : data;                     // NOLINT(*constant-array-index, *pointer-arithmetic)
+}
+
+auto CaptureImpl::yuv420_planes(BufferHandle const& handle) const -> std::array<ImagePlane, 3>
+{
+    bool const is_nv12       = history_format(_pixel_format) == HistoryFrameFormat::NV12;
+    auto const bytes_per_row = [&](size_t plane) -> size_t { // Some drivers leave bytesperline to 0 when the rows are not padded
+        return std::max<size_t>(_bytes_per_line[plane], is_nv12 ? NV12::plane_row_size(plane, _resolution) : I420::plane_row_size(plane, _resolution)); // NOLINT(*constant-array-index)
+    };
+    if (_buffers[handle.buf.index].planes_count > 1) // NOLINT(*constant-array-index) Each plane is in its own buffer (NV12M and YUV420M)
+    {
+        auto const u_plane = ImagePlane{plane_data(handle, 1), bytes_per_row(1)};
+        return {ImagePlane{plane_data(handle, 0), bytes_per_row(0)}, u_plane, is_nv12 ? u_plane : ImagePlane{plane_data(handle, 2), bytes_per_row(2)}};
+    }
+    // The planes follow each other in the same buffer. The driver only gives us the bytesperline of the luma plane, and the chroma planes of I420 use half of it.
+    auto const  luma_plane = ImagePlane{plane_data(handle), bytes_per_row(0)};
+    auto const* chroma     = luma_plane.data + luma_plane.bytes_per_row * _resolution.height(); // NOLINT(*pointer-arithmetic)
+    if (is_nv12)
+        return {luma_plane, ImagePlane{chroma, luma_plane.bytes_per_row}, ImagePlane{chroma, luma_plane.bytes_per_row}};
+    auto const chroma_bytes_per_row = luma_plane.bytes_per_row / 2;
+    return {luma_plane, ImagePlane{chroma, chroma_bytes_per_row}, ImagePlane{chroma + chroma_bytes_per_row * (_resolution.height() / 2), chroma_bytes_per_row}}; // NOLINT(*pointer-arithmetic)
+}
+
+/// Copies the planes one after the other, without the padding at the end of their rows, unless they are already laid out like that
+template<typename PixelFormatT>
+static auto make_contiguous(ImagePlanesView<PixelFormatT> const& view, PooledBuffer& buffer) -> std::span<uint8_t const>
+{
+    auto const size = PixelFormatT::data_length(view.resolution());
+    if (view.is_contiguous())
+        return {view.plane(0).data, size};
+
+    if (buffer.size() != size)
+        buffer = buffer_pool().acquire(size);
+    auto* destination = buffer.data();
+    for (size_t i = 0; i < PixelFormatT::planes_count; ++i)
+    {
+        auto const row_size = PixelFormatT::plane_row_size(i, view.resolution());
+        for (size_t row = 0; row < PixelFormatT::plane_rows_count(i, view.resolution()); ++row)
+        {
+            std::memcpy(destination, view.plane(i).data + row * view.plane(i).bytes_per_row, row_size); // NOLINT(*pointer-arithmetic)
+            destination += row_size;                                                                    // NOLINT(*pointer-arithmetic)
+        }
+    }
+    return {buffer.data(), size};
+}
+
+auto CaptureImpl::contiguous_frame(BufferHandle const& handle) -> std::span<uint8_t const>
+{
+    auto const format = history_format(_pixel_format);
+    if (format == HistoryFrameFormat::NV12)
+    {
+        auto const planes = yuv420_planes(handle);
+        return make_contiguous(ImagePlanesView<NV12>{{planes[0], planes[1]}, _resolution, wcam::FirstRowIs::Top}, _contiguous_frame);
+    }
+    if (format == HistoryFrameFormat::I420)
+        return make_contiguous(ImagePlanesView<I420>{yuv420_planes(handle), _resolution, wcam::FirstRowIs::Top}, _contiguous_frame);
+    return {plane_data(handle), bytes_used(handle)};
+}
 
-    info.err = jpeg_std_error(&err);
-    jpeg_create_decompress(&info);
+auto CaptureImpl::motion_score(BufferHandle const& handle) -> std::optional<float>
+{
+    if (_pixel_format == V4L2_PIX_FMT_YUYV)
+        return motion_gate().filter(luma_grid(ImageDataView<YUYV>{plane_data(handle), YUYV::data_length(_resolution), _resolution, wcam::FirstRowIs::Top}));
+    if (_pixel_format == V4L2_PIX_FMT_MJPEG)
+    {
+        auto const grid = mjpeg_luma_grid(plane_data(handle), bytes_used(handle));
+        if (!grid)
+            return std::nullopt; // The frame is corrupted, drop it
+        return motion_gate().filter(*grid);
+    }
+    auto const format = history_format(_pixel_format);
+    if (format == HistoryFrameFormat::NV12 || format == HistoryFrameFormat::I420)
+        return motion_gate().filter(luma_grid(yuv420_planes(handle)[0], _resolution));
+    return 1.f;
+}
 
-    jpeg_mem_src(&info, static_cast<unsigned char*>(buffer.ptr), buffer.size);
-    jpeg_read_header(&info, TRUE);
-    jpeg_start_decompress(&info);
+/// Most drivers use CLOCK_MONOTONIC, which is also what steady_clock uses on Linux, so we can compare the timestamps of different cameras, and with the current time
+static auto frame_timestamp(v4l2_buffer const& buf) -> std::chrono::steady_clock::time_point
+{
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+        return std::chrono::steady_clock::now();
+    return std::chrono::steady_clock::time_point{std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds{buf.timestamp.tv_sec} + std::chrono::microseconds{buf.timestamp.tv_usec})};
+}
 
-    while (info.output_scanline < info.output_height)
+auto CaptureImpl::dequeue_most_recent_buffer(BufferHandle const& handle) -> BufferHandle
+{
+    auto most_recent = handle;
+    while (true)
     {
-        unsigned char* buffer_array = rgb_data + static_cast<uint64_t>(info.output_scanline) * static_cast<uint64_t>(info.output_width) * static_cast<uint64_t>(info.output_components); // NOLINT(*pointer-arithmetic)
-        jpeg_read_scanlines(&info, &buffer_array, 1);
+        auto poll_fd = pollfd{.fd = _webcam_handle, .events = POLLIN, .revents = 0};
+        if (poll(&poll_fd, 1, 0) <= 0 || !(poll_fd.revents & POLLIN)) // Don't wait, we only want the frames that are already there
+            return most_recent;
+
+        auto newer = make_buffer_handle();
+        if (buffer_ioctl(VIDIOC_DQBUF, newer) == -1)
+            return most_recent;
+        if (_uvc_metadata)
+            _uvc_metadata->drain(); // Even for the frames that we skip, see UvcMetadataStream::drain()
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, most_recent)); // Give the older frame back to the driver without decoding it
+        most_recent = newer;
     }
+}
 
-    jpeg_finish_decompress(&info);
-    jpeg_destroy_decompress(&info);
+auto CaptureImpl::capture_burst(size_t frames_count, std::vector<PooledBuffer> buffers) -> MaybeBurst
+{
+    try
+    {
+        // Allocate everything before the first frame, so that nothing slows us down during the burst
+        auto const max_frame_size = std::max_element(_buffers.begin(), _buffers.end(), [](Buffer const& a, Buffer const& b) {
+                                        return a.total_size() < b.total_size();
+                                    })->total_size();
+        {
+            auto const allocations_account = count_allocations();
+            buffers.resize(frames_count);
+            for (auto& buffer : buffers)
+            {
+                if (buffer.size() < max_frame_size)
+                    buffer = buffer_pool().acquire(max_frame_size);
+            }
+        }
+        auto frames = std::vector<BurstFrame>{};
+        frames.reserve(frames_count);
+
+        for (auto const& buffer : buffers)
+        {
+            auto handle = BufferHandle{};
+            while (true)
+            {
+                while (!wait_for_frame(std::chrono::milliseconds{100}))
+                {
+                    if (_wants_to_stop_thread.load()) // Don't block stop_thread() (and therefore reconfigure() and the destructor) while the camera doesn't send anything
+                        return Error_Unknown{"The capture was stopped before the burst was complete"};
+                }
+                handle = make_buffer_handle();
+                THROW_IF_ERR(buffer_ioctl(VIDIOC_DQBUF, handle));
+                if (!(handle.buf.flags & V4L2_BUF_FLAG_ERROR) && bytes_used(handle) != 0)
+                    break;
+                THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // Skip the broken frames, like process_next_image() does
+            }
+            auto const frame = contiguous_frame(handle);
+            std::memcpy(buffer.data(), frame.data(), frame.size());
+            THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // Give the buffer back as soon as possible, so that the driver never runs out of buffers
+
+            frames.push_back(BurstFrame{
+                .sequence = handle.buf.sequence,
+                .frame    = HistoryFrame{
+                       .timestamp  = frame_timestamp(handle.buf),
+                       .format     = history_format(_pixel_format),
+                       .resolution = _resolution,
+                       .row_order  = wcam::FirstRowIs::Top,
+                       .data       = buffer.shared_data(),
+                       .data_size  = frame.size(),
+                },
+            });
+        }
+        return frames;
+    }
+    catch (CaptureException const& e)
+    {
+        return e.capture_error;
+    }
+}
+
+auto CaptureImpl::wait_for_frame(std::chrono::milliseconds timeout) const -> bool
+{
+    auto poll_fd = pollfd{.fd = _webcam_handle, .events = POLLIN, .revents = 0};
+    return poll(&poll_fd, 1, static_cast<int>(timeout.count())) > 0 && (poll_fd.revents & POLLIN);
+}
+
+auto CaptureImpl::grab_raw_frame() -> HistoryFrame
+{
+    // This runs on the Manager thread, so a camera that stalls must not block it for long: it would freeze the hot-plug detection and the restarts of all the cameras
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    for (int broken_frames_count = 0; broken_frames_count < 30; ++broken_frames_count)
+    {
+        auto const remaining_time = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining_time <= std::chrono::milliseconds{0} || !wait_for_frame(remaining_time))
+            break;
+        auto handle = make_buffer_handle();
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_DQBUF, handle));
+        if ((handle.buf.flags & V4L2_BUF_FLAG_ERROR) || bytes_used(handle) == 0) // Some cameras send a few broken frames right after the stream starts
+        {
+            THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle));
+            continue;
+        }
+
+        auto const frame = contiguous_frame(handle);
+        auto       copy  = std::shared_ptr<uint8_t[]>(new uint8_t[frame.size()]); // NOLINT(*c-arrays, *owning-memory)
+        std::memcpy(copy.get(), frame.data(), frame.size());
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle));
+        return HistoryFrame{
+            .timestamp  = frame_timestamp(handle.buf),
+            .format     = history_format(_pixel_format),
+            .resolution = _resolution,
+            .row_order  = wcam::FirstRowIs::Top,
+            .data       = std::shared_ptr<uint8_t const>{copy, copy.get()},
+            .data_size  = frame.size(),
+        };
+    }
+    throw CaptureException{Error_Unknown{"The camera didn't send a valid frame in time"}};
+}
+
+auto CaptureImpl::capture_still(Resolution const& resolution) -> MaybeStill
+{
+    auto const stream_resolution = _resolution;
+    stop_thread();
+    stop_stream(); // Same as reconfigure(), we keep the file open to switch as fast as possible
+    auto still = MaybeStill{};
+    try
+    {
+        _resolution = resolution;
+        start_stream();
+        still = grab_raw_frame();
+    }
+    catch (CaptureException const& e)
+    {
+        still = e.capture_error;
+    }
+
+    stop_stream();
+    _resolution = stream_resolution;
+    try
+    {
+        start_stream();
+        start_thread();
+    }
+    catch (CaptureException const&)
+    {
+        request_restart(); // The Manager will try again, or recreate the capture
+    }
+    return still;
 }
 
 void CaptureImpl::process_next_image()
 {
     try
     {
-        auto buf   = v4l2_buffer{};
-        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
+        auto handle = make_buffer_handle();
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_DQBUF, handle)); // Blocks until a new frame is available
+        if (_uvc_metadata)
+            _uvc_metadata->drain(); // Even if we then drop the frame, see UvcMetadataStream::drain()
+        if (device_settings<LatencySettings>().settings(id()).low_latency)
+            handle = dequeue_most_recent_buffer(handle);
+        auto const timestamp = frame_timestamp(handle.buf);
+        if (is_history_enabled())
+        {
+            auto const frame = contiguous_frame(handle);
+            record_in_history(timestamp, history_format(_pixel_format), frame.data(), frame.size(), _resolution, wcam::FirstRowIs::Top);
+        }
+        if (is_duplicate_frame(plane_data(handle), bytes_used(handle)) // Before the rate limit, so that duplicates don't use its slots, and so that we always compare with the previous frame of the camera. For the multi-planar formats we only look at the first plane, which is enough to tell whether the image changed.
+            || !is_frame_wanted()
+            || !_adaptive_quality->should_process_frame())
+        {
+            THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // Give the buffer back to the driver without decoding it
+            return;
+        }
 
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_DQBUF, &buf)); // Blocks until a new frame is available
-        auto image = image_factory().make_image();
+        auto const processing_start = std::chrono::steady_clock::now();
+        auto       score            = std::optional<float>{};
+        if (motion_gate().is_enabled())
+        {
+            score = motion_score(handle);
+            if (!score)
+            {
+                THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // Nothing moved, no need to decode the frame
+                return;
+            }
+        }
 
-        if (_pixel_format == V4L2_PIX_FMT_YUYV)
+        auto const jpeg_scale_denominator = _adaptive_quality->jpeg_scale_denominator();
+        auto const max_memory_scale       = _pixel_format == V4L2_PIX_FMT_MJPEG ? std::max(8u / jpeg_scale_denominator, 1u) : 1u; // libjpeg can't scale down more than 1/8
+        auto const memory_scale           = admit_frame(_resolution.pixels_count() / (jpeg_scale_denominator * jpeg_scale_denominator) * 3, max_memory_scale); // Might block, which delays the moment we give the buffer back to the driver
+        if (!memory_scale)
         {
-            image->set_data(ImageDataView<YUYV>{static_cast<unsigned char*>(_buffers[buf.index].ptr), _buffers[buf.index].size, _resolution, wcam::FirstRowIs::Top}); // NOLINT(*constant-array-index)
+            THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // We don't have enough memory left to decode the frame
+            return;
         }
-        else if (_pixel_format == V4L2_PIX_FMT_MJPEG)
+        auto const scale_denominator = jpeg_scale_denominator * *memory_scale; // The one that the memory budget admitted
+        auto const allocations_account = count_allocations();
+        auto       image               = make_image();
+
+        auto const rows_per_slice = this->rows_per_slice();
+        auto const on_rows_decoded = [&](DecodedImage const& decoded_image, uint32_t first_row, uint32_t rows_count) {
+            publish_slice({
+                .rgb_data   = decoded_image.rgb_data,
+                .resolution = decoded_image.resolution,
+                .first_row  = first_row,
+                .rows_count = rows_count,
+                .timestamp  = timestamp,
+            });
+        };
+
+        if (_pixel_format == V4L2_PIX_FMT_YUYV && rows_per_slice)
         {
-            auto rgb_data = std::shared_ptr<uint8_t>{new uint8_t[_resolution.pixels_count() * 3], std::default_delete<uint8_t[]>()}; // NOLINT(*c-arrays)
-            mjpeg_to_rgb(_buffers[buf.index], rgb_data.get());                                                                       // NOLINT(*constant-array-index)
+            auto rgb_data = buffer_pool().acquire(_resolution.pixels_count() * 3).shared_data();
+            for (uint32_t first_row = 0; first_row < _resolution.height(); first_row += *rows_per_slice)
+            {
+                auto const rows_count = std::min(*rows_per_slice, _resolution.height() - first_row);
+                yuyv_to_rgb(plane_data(handle), rgb_data.get(), _resolution, first_row, rows_count);
+                on_rows_decoded({rgb_data, _resolution}, first_row, rows_count);
+            }
             image->set_data(ImageDataView<RGB24>{std::move(rgb_data), _resolution.pixels_count() * 3, _resolution, wcam::FirstRowIs::Top});
         }
+        else if (_pixel_format == V4L2_PIX_FMT_YUYV)
+        {
+            image->set_data(ImageDataView<YUYV>{plane_data(handle), YUYV::data_length(_resolution), _resolution, wcam::FirstRowIs::Top});
+        }
+        else if (history_format(_pixel_format) == HistoryFrameFormat::NV12)
+        {
+            auto const planes = yuv420_planes(handle);
+            image->set_data(ImagePlanesView<NV12>{{planes[0], planes[1]}, _resolution, wcam::FirstRowIs::Top}); // Zero-copy, the image reads directly from the buffers of the driver
+        }
+        else if (history_format(_pixel_format) == HistoryFrameFormat::I420)
+        {
+            image->set_data(ImagePlanesView<I420>{yuv420_planes(handle), _resolution, wcam::FirstRowIs::Top}); // Zero-copy, the image reads directly from the buffers of the driver
+        }
+        else if (_pixel_format == V4L2_PIX_FMT_MJPEG)
+        {
+            auto decoded_image = mjpeg_to_rgb(plane_data(handle), bytes_used(handle), scale_denominator, rows_per_slice ? RowsDecodedCallback{on_rows_decoded} : RowsDecodedCallback{}, rows_per_slice.value_or(0));
+            if (!decoded_image)
+            {
+                THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // The frame is corrupted (e.g. it was truncated during the USB transfer), drop it
+                return;
+            }
+            image->set_data(ImageDataView<RGB24>{std::move(decoded_image->rgb_data), decoded_image->resolution.pixels_count() * 3, decoded_image->resolution, wcam::FirstRowIs::Top});
+        }
+        else if (auto const bayer = bayer_format(history_format(_pixel_format)))
+        {
+            if (!set_bayer_data(*image, plane_data(handle), bytes_used(handle), _bytes_per_line[0], _resolution, wcam::FirstRowIs::Top, *bayer, device_settings<BayerSettings>().settings(id())))
+            {
+                THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // The frame is truncated, drop it
+                return;
+            }
+        }
+        else if (is_gray_format(history_format(_pixel_format)))
+        {
+            if (!set_gray_data(*image, plane_data(handle), bytes_used(handle), _bytes_per_line[0], _resolution, wcam::FirstRowIs::Top, history_format(_pixel_format)))
+            {
+                THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle)); // The frame is truncated, drop it
+                return;
+            }
+        }
         else
         {
             assert(false && "Unsupported pixel format");
         };
+        set_frame_metadata(*image, {
+                                       .timestamp        = timestamp,
+                                       .device_timestamp = _uvc_metadata ? _uvc_metadata->device_timestamp(handle.buf.sequence) : std::nullopt,
+                                       .motion_score     = score,
+                                   });
         set_image(std::move(image));
-        THROW_IF_ERR(ioctl(_webcam_handle, VIDIOC_QBUF, &buf));
+        THROW_IF_ERR(buffer_ioctl(VIDIOC_QBUF, handle));
+
+        _adaptive_quality->on_frame_processed(std::chrono::steady_clock::now() - processing_start);
+        if (_adaptive_quality->wants_to_change_resolution())
+            request_restart();
     }
     catch (CaptureException const& e)
     {
@@ -291,4 +969,4 @@ void CaptureImpl::process_next_image()
 }
 
 } // namespace wcam::internal
-#endif
\ No newline at end of file
+#endif
@@ -1,16 +1,31 @@
 #pragma once
 #if defined(__linux__)
+#include <linux/videodev2.h>
 #include <array>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <thread>
+#include <vector>
 #include "../DeviceId.hpp"
+#include "../Image.hpp"
+#include "AdaptiveQualityController.hpp"
 #include "ICaptureImpl.hpp"
+#include "UsbBandwidthBudget.hpp"
 
 namespace wcam::internal {
 
+class UvcMetadataStream;
+
 struct Buffer {
-    void*  ptr{};
-    size_t size{};
+    struct Plane {
+        void*  ptr{};
+        size_t size{};
+    };
+    std::array<Plane, VIDEO_MAX_PLANES> planes{}; // Only the first one is used, except by the multi-planar formats that store each plane in its own buffer (e.g. NV12M)
+    size_t                              planes_count{0};
 
     Buffer() = default;
     ~Buffer();
@@ -18,6 +33,15 @@ struct Buffer {
     Buffer& operator=(Buffer const&)     = delete;
     Buffer(Buffer&&) noexcept            = delete;
     Buffer& operator=(Buffer&&) noexcept = delete;
+
+    void               unmap();
+    [[nodiscard]] auto total_size() const -> size_t;
+};
+
+/// A v4l2_buffer, along with the description of its planes that the multi-planar API needs
+struct BufferHandle {
+    v4l2_buffer                              buf{};
+    std::array<v4l2_plane, VIDEO_MAX_PLANES> planes{};
 };
 
 class FileRAII {
@@ -44,22 +68,66 @@ private:
 
 class CaptureImpl : public ICaptureImpl {
 public:
-    CaptureImpl(DeviceId const& id, Resolution const& resolution);
+    CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions);
     ~CaptureImpl() override;
     CaptureImpl(CaptureImpl const&)                        = delete;
     auto operator=(CaptureImpl const&) -> CaptureImpl&     = delete;
     CaptureImpl(CaptureImpl&&) noexcept                    = delete;
     auto operator=(CaptureImpl&&) noexcept -> CaptureImpl& = delete;
 
+    /// Stops only the stream and its buffers, and restarts them with the new resolution, on the same file descriptor
+    auto reconfigure(Resolution const&) -> bool override;
+    /// Stops the stream, captures one frame at the still resolution, and restarts the stream at the current resolution
+    auto capture_still(Resolution const&) -> MaybeStill override;
+    void start_burst(BurstRequest) override;
+
 private:
-    static void thread_job(CaptureImpl&);
-    void        process_next_image();
+    void               start_thread();
+    void               stop_thread();
+    /// Throws a CaptureException if it fails
+    void               start_stream();
+    void               stop_stream();
+    static void        thread_job(CaptureImpl&);
+    void               process_next_image();
+    /// Runs on the capture thread, instead of the usual processing of the frames
+    [[nodiscard]] auto capture_burst(size_t frames_count, std::vector<PooledBuffer> buffers) -> MaybeBurst;
+    /// Waits until the camera sends a valid frame, and returns a copy of its raw data. Throws a CaptureException if it doesn't send one in time.
+    [[nodiscard]] auto grab_raw_frame() -> HistoryFrame;
+    /// Returns false if the driver has no frame for us before the timeout, so that we never block forever on a camera that stalls
+    [[nodiscard]] auto wait_for_frame(std::chrono::milliseconds timeout) const -> bool;
+    /// Takes all the frames that are already waiting in the queue, gives them back to the driver, and returns the most recent one
+    [[nodiscard]] auto dequeue_most_recent_buffer(BufferHandle const&) -> BufferHandle;
+    /// Only decodes the luminance needed by the motion gate, and returns std::nullopt if the frame should be dropped
+    [[nodiscard]] auto motion_score(BufferHandle const&) -> std::optional<float>;
+
+    [[nodiscard]] auto is_multiplanar() const -> bool { return _buffer_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE; }
+    [[nodiscard]] auto make_buffer_handle() const -> BufferHandle;
+    /// Use this instead of calling ioctl() directly with `handle.buf`, because it needs to point to `handle.planes` when we use the multi-planar API
+    [[nodiscard]] auto buffer_ioctl(unsigned long request, BufferHandle& handle) const -> int;
+    [[nodiscard]] auto bytes_used(BufferHandle const&, size_t plane = 0) const -> size_t;
+    [[nodiscard]] auto plane_data(BufferHandle const&, size_t plane = 0) const -> uint8_t const*;
+    /// The Y, U and V planes of an NV12 or I420 frame. For NV12, U and V are the same plane, where they are interleaved.
+    [[nodiscard]] auto yuv420_planes(BufferHandle const&) const -> std::array<ImagePlane, 3>;
+    /// The whole frame in a single block of memory, which is what the history, the stills and the bursts store.
+    /// Only copies the frame when its planes are in separate buffers, or when their rows are padded.
+    [[nodiscard]] auto contiguous_frame(BufferHandle const&) -> std::span<uint8_t const>;
 
 private:
-    FileRAII              _webcam_handle;
-    std::array<Buffer, 6> _buffers; // 6 is nice number that gives us good performance
-    uint32_t              _pixel_format;
-    Resolution            _resolution;
+    FileRAII                               _webcam_handle;
+    v4l2_buf_type                          _buffer_type{V4L2_BUF_TYPE_VIDEO_CAPTURE}; // V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE for the devices that only support the multi-planar API
+    std::vector<Buffer>                    _buffers{};                                // The number of buffers is set by the LatencySettings
+    uint32_t                               _pixel_format{};
+    std::array<uint32_t, VIDEO_MAX_PLANES> _bytes_per_line{};                         // For each plane, as chosen by the driver
+    Resolution                             _resolution;
+    bool                                   _is_streaming{false};
+    PooledBuffer                           _contiguous_frame{};                       // Reused by contiguous_frame()
+
+    UsbBandwidthReservation                  _usb_bandwidth_reservation{};
+    std::optional<AdaptiveQualityController> _adaptive_quality{}; // Optional only because it can't be created before we know the pixel format
+    std::unique_ptr<UvcMetadataStream>       _uvc_metadata{};     // Only when hardware timestamps are enabled and supported by the camera
+
+    std::vector<BurstRequest> _burst_requests{};
+    std::mutex                _burst_requests_mutex{};
 
     std::atomic<bool> _wants_to_stop_thread{false};
     std::thread       _thread{};
@@ -5,7 +5,8 @@ namespace wcam::internal {
 
 void open_webcam();
 
-CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution)
+CaptureImpl::CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions)
+    : ICaptureImpl{id, std::move(subscriptions)}
 {
     open_webcam();
 }
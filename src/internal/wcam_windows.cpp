@@ -1,6 +1,7 @@
 #if defined(_WIN32)
 #include "wcam_windows.hpp"
 #include <fmt/format.h>
+#include <chrono>
 #include <cstdlib>
 #include <source_location/source_location.hpp>
 #include <string>
@@ -8,7 +9,7 @@
 #include <unordered_map>
 #include "../Info.hpp"
 #include "Cool/get_system_error_hresult.hpp"
-#include "ImageFactory.hpp"
+#include "ThreadSettingsManager.hpp"
 #include "fallback_webcam_name.hpp"
 #include "make_device_id.hpp"
 
@@ -323,8 +324,10 @@ static auto get_actual_resolution(ISampleGrabber* sample_grabber, GUID video_for
     return resolution;
 }
 
-CaptureImpl::CaptureImpl(DeviceId const& device_id, Resolution const& requested_resolution)
-    : _video_format{select_video_format(device_id)}
+CaptureImpl::CaptureImpl(DeviceId const& device_id, Resolution const& requested_resolution, std::shared_ptr<Subscriptions const> subscriptions)
+    : ICaptureImpl{device_id, std::move(subscriptions)}
+    , _video_format{select_video_format(device_id)}
+    , _adaptive_quality{device_id, false /*supports_scaled_decode*/}
 {
     CoInitializeIFN();
 
@@ -366,22 +369,51 @@ CaptureImpl::CaptureImpl(DeviceId const& device_id, Resolution const& requested_
 
 STDMETHODIMP CaptureImpl::BufferCB(double /* time */, BYTE* buffer, long buffer_length) // NOLINT(*runtime-int)
 {
-    auto image = image_factory().make_image();
+    thread_settings_manager().apply_settings_if_they_changed(ThreadRole::Capture); // BufferCB is called on a thread created by DirectShow, so this is the only place where we can apply our settings
+    auto const timestamp = std::chrono::steady_clock::now(); // The time given by DirectShow is relative to the start of the stream, so it can't be compared across cameras
     if (_video_format == MEDIASUBTYPE_RGB24)
-    {
-        image->set_data(ImageDataView<BGR24>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Bottom});
-    }
+        record_in_history(timestamp, HistoryFrameFormat::BGR24, buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Bottom);
     else if (_video_format == MEDIASUBTYPE_NV12)
+        record_in_history(timestamp, HistoryFrameFormat::NV12, buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Top);
+    if (is_duplicate_frame(buffer, static_cast<size_t>(buffer_length)) // Before the rate limit, so that duplicates don't use its slots, and so that we always compare with the previous frame of the camera
+        || !is_frame_wanted()
+        || !_adaptive_quality.should_process_frame())
     {
-        image->set_data(ImageDataView<NV12>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Top});
+        return S_OK;
     }
-    else
+
+    if (_video_format != MEDIASUBTYPE_RGB24 && _video_format != MEDIASUBTYPE_NV12)
     {
         ICaptureImpl::set_image(Error_Unknown{"Unsupported pixel format"});
         return S_OK;
     }
 
-    ICaptureImpl::set_image(std::move(image));
+    auto const processing_start = std::chrono::steady_clock::now();
+    auto const process_frame    = [&](auto const& view) { // The view must only be created for the format of the camera, because its constructor checks that the size of the buffer matches
+        auto score = std::optional<float>{};
+        if (motion_gate().is_enabled())
+        {
+            score = motion_gate().filter(luma_grid(view));
+            if (!score)
+                return; // Nothing moved, no need to convert the frame
+        }
+        if (!admit_frame(_resolution.pixels_count() * 3, 1)) // Might block, which applies backpressure on DirectShow
+            return;
+
+        auto const allocations_account = count_allocations();
+        auto       image               = make_image();
+        image->set_data(view);
+        set_frame_metadata(*image, {.timestamp = timestamp, .motion_score = score});
+        ICaptureImpl::set_image(std::move(image));
+
+        _adaptive_quality.on_frame_processed(std::chrono::steady_clock::now() - processing_start);
+        if (_adaptive_quality.wants_to_change_resolution())
+            request_restart();
+    };
+    if (_video_format == MEDIASUBTYPE_RGB24)
+        process_frame(ImageDataView<BGR24>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Bottom});
+    else
+        process_frame(ImageDataView<NV12>{buffer, static_cast<size_t>(buffer_length), _resolution, wcam::FirstRowIs::Top});
     return S_OK;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #if defined(_WIN32)
 #include "../DeviceId.hpp"
+#include "AdaptiveQualityController.hpp"
 #include "ICaptureImpl.hpp"
 #include "qedit.h"
 
@@ -33,7 +34,7 @@ EXTERN_C const IID IID_ISampleGrabberCB;
 class CaptureImpl : public ISampleGrabberCB
     , public ICaptureImpl {
 public:
-    CaptureImpl(DeviceId const& id, Resolution const& resolution);
+    CaptureImpl(DeviceId const& id, Resolution const& resolution, std::shared_ptr<Subscriptions const> subscriptions);
     ~CaptureImpl() override                                = default;
     CaptureImpl(CaptureImpl const&)                        = delete;
     auto operator=(CaptureImpl const&) -> CaptureImpl&     = delete;
@@ -55,8 +56,9 @@ private:
     Resolution _resolution{};
     GUID       _video_format{}; // At the moment we support MEDIASUBTYPE_RGB24 and MEDIASUBTYPE_NV12 (which is required for the OBS virtual camera)
 
-    MediaControlRAII _media_control{};
-    ULONG            _ref_count{0};
+    AdaptiveQualityController _adaptive_quality;
+    MediaControlRAII          _media_control{};
+    ULONG                     _ref_count{0};
 };
 
 } // namespace wcam::internal
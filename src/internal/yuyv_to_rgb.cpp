@@ -0,0 +1,33 @@
+#include "yuyv_to_rgb.hpp"
+#include <algorithm>
+
+namespace wcam::internal {
+
+void yuyv_to_rgb(uint8_t const* yuyv, uint8_t* rgb, Resolution resolution, uint32_t first_row, uint32_t rows_count)
+{
+    uint64_t const begin = static_cast<uint64_t>(first_row) * resolution.width() * 2;
+    uint64_t const end   = static_cast<uint64_t>(first_row + rows_count) * resolution.width() * 2;
+    for (uint64_t i = begin; i < end; i += 4)
+    {
+        auto const y0 = static_cast<int>(yuyv[i + 0] << 8);  // NOLINT(*pointer-arithmetic)
+        auto const u  = static_cast<int>(yuyv[i + 1] - 128); // NOLINT(*pointer-arithmetic)
+        auto const y1 = static_cast<int>(yuyv[i + 2] << 8);  // NOLINT(*pointer-arithmetic)
+        auto const v  = static_cast<int>(yuyv[i + 3] - 128); // NOLINT(*pointer-arithmetic)
+
+        int const r0 = (y0 + 359 * v) >> 8;
+        int const g0 = (y0 - 88 * u - 183 * v) >> 8;
+        int const b0 = (y0 + 454 * u) >> 8;
+        int const r1 = (y1 + 359 * v) >> 8;
+        int const g1 = (y1 - 88 * u - 183 * v) >> 8;
+        int const b1 = (y1 + 454 * u) >> 8;
+
+        rgb[i * 3 / 2 + 0] = static_cast<uint8_t>(std::clamp(r0, 0, 255)); // NOLINT(*pointer-arithmetic)
+        rgb[i * 3 / 2 + 1] = static_cast<uint8_t>(std::clamp(g0, 0, 255)); // NOLINT(*pointer-arithmetic)
+        rgb[i * 3 / 2 + 2] = static_cast<uint8_t>(std::clamp(b0, 0, 255)); // NOLINT(*pointer-arithmetic)
+        rgb[i * 3 / 2 + 3] = static_cast<uint8_t>(std::clamp(r1, 0, 255)); // NOLINT(*pointer-arithmetic)
+        rgb[i * 3 / 2 + 4] = static_cast<uint8_t>(std::clamp(g1, 0, 255)); // NOLINT(*pointer-arithmetic)
+        rgb[i * 3 / 2 + 5] = static_cast<uint8_t>(std::clamp(b1, 0, 255)); // NOLINT(*pointer-arithmetic)
+    }
+}
+
+} // namespace wcam::internal
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+#include "../Resolution.hpp"
+
+namespace wcam::internal {
+
+/// Converts the rows [first_row, first_row + rows_count) of a YUYV image into the same rows of an RGB24 image of the same resolution
+void yuyv_to_rgb(uint8_t const* yuyv, uint8_t* rgb, Resolution resolution, uint32_t first_row, uint32_t rows_count);
+
+} // namespace wcam::internal
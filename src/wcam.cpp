@@ -1,6 +1,14 @@
 #include "wcam/wcam.hpp"
+#include "internal/AdaptiveQualityManager.hpp"
+#include "internal/BackendsRegistry.hpp"
+#include "internal/BufferPool.hpp"
+#include "internal/DeviceSettingsManager.hpp"
+#include "internal/HistoryRing.hpp"
 #include "internal/Manager.hpp"
+#include "internal/MemoryBudgetManager.hpp"
 #include "internal/ResolutionsManager.hpp"
+#include "internal/ThreadSettingsManager.hpp"
+#include "internal/VirtualWebcamsManager.hpp"
 
 namespace wcam {
 
@@ -14,6 +22,26 @@ auto open_webcam(DeviceId const& id) -> SharedWebcam
     return internal::manager()->open_or_get_webcam(id);
 }
 
+auto add_virtual_webcam(DeviceId const& physical_webcam, CropRegion region, std::string name) -> DeviceId
+{
+    return internal::virtual_webcams_manager().add(physical_webcam, region, std::move(name));
+}
+
+void remove_virtual_webcam(DeviceId const& id)
+{
+    internal::virtual_webcams_manager().remove(id);
+}
+
+void register_backend(std::string name, std::shared_ptr<Backend> backend)
+{
+    internal::backends_registry().add(std::move(name), std::move(backend));
+}
+
+void unregister_backend(std::string const& name)
+{
+    internal::backends_registry().remove(name);
+}
+
 auto get_selected_resolution(DeviceId const& id) -> Resolution
 {
     return internal::resolutions_manager().selected_resolution(id);
@@ -29,4 +57,140 @@ auto get_resolutions_map() -> ResolutionsMap&
     return internal::resolutions_manager().get_map();
 }
 
+auto get_adaptive_quality(DeviceId const& id) -> AdaptiveQualitySettings
+{
+    return internal::adaptive_quality_manager().settings(id);
+}
+
+void set_adaptive_quality(DeviceId const& id, AdaptiveQualitySettings settings)
+{
+    internal::adaptive_quality_manager().set_settings(id, settings);
+}
+
+auto get_duplicate_frames_policy(DeviceId const& id) -> DuplicateFramesPolicy
+{
+    return internal::device_settings<DuplicateFramesPolicy>().settings(id);
+}
+
+void set_duplicate_frames_policy(DeviceId const& id, DuplicateFramesPolicy policy)
+{
+    internal::device_settings<DuplicateFramesPolicy>().set_settings(id, policy);
+}
+
+auto get_motion_gate(DeviceId const& id) -> MotionGateSettings
+{
+    return internal::device_settings<MotionGateSettings>().settings(id);
+}
+
+void set_motion_gate(DeviceId const& id, MotionGateSettings settings)
+{
+    internal::device_settings<MotionGateSettings>().set_settings(id, settings);
+}
+
+auto get_hardware_timestamps(DeviceId const& id) -> HardwareTimestampsSettings
+{
+    return internal::device_settings<HardwareTimestampsSettings>().settings(id);
+}
+
+void set_hardware_timestamps(DeviceId const& id, HardwareTimestampsSettings settings)
+{
+    if (get_hardware_timestamps(id).enabled == settings.enabled)
+        return; // No need to restart the capture
+    internal::device_settings<HardwareTimestampsSettings>().set_settings(id, settings);
+
+    auto const manager = internal::manager_unchecked();
+    if (manager)
+        manager->request_a_restart_of_the_capture_if_it_exists(id); // The metadata stream can only be opened when the capture starts
+}
+
+auto get_bayer(DeviceId const& id) -> BayerSettings
+{
+    return internal::device_settings<BayerSettings>().settings(id);
+}
+
+void set_bayer(DeviceId const& id, BayerSettings settings)
+{
+    internal::device_settings<BayerSettings>().set_settings(id, settings);
+}
+
+auto get_latency(DeviceId const& id) -> LatencySettings
+{
+    return internal::device_settings<LatencySettings>().settings(id);
+}
+
+void set_latency(DeviceId const& id, LatencySettings settings)
+{
+    bool const needs_restart = get_latency(id).buffers_count != settings.buffers_count;
+    internal::device_settings<LatencySettings>().set_settings(id, settings);
+
+    auto const manager = internal::manager_unchecked();
+    if (needs_restart && manager)
+        manager->request_a_restart_of_the_capture_if_it_exists(id); // The buffers can only be allocated when the stream starts
+}
+
+auto get_memory_budget() -> MemoryBudget
+{
+    return internal::memory_budgets().global_budget();
+}
+
+void set_memory_budget(MemoryBudget budget)
+{
+    internal::memory_budgets().set_global_budget(budget);
+}
+
+auto get_memory_budget(DeviceId const& id) -> MemoryBudget
+{
+    return internal::device_settings<MemoryBudget>().settings(id);
+}
+
+void set_memory_budget(DeviceId const& id, MemoryBudget budget)
+{
+    internal::device_settings<MemoryBudget>().set_settings(id, budget);
+    internal::memory_budgets().on_memory_freed(); // The new budget might be bigger, and allow the capture to continue if it is waiting
+}
+
+auto memory_usage() -> MemoryUsage
+{
+    auto usage         = internal::memory_budgets().global_account().usage();
+    usage.cached_bytes = internal::buffer_pool().cached_bytes();
+    return usage;
+}
+
+auto memory_usage(DeviceId const& id) -> MemoryUsage
+{
+    return internal::memory_budgets().account(id)->usage();
+}
+
+auto get_history(DeviceId const& id) -> HistorySettings
+{
+    return internal::device_settings<HistorySettings>().settings(id);
+}
+
+void set_history(DeviceId const& id, HistorySettings settings)
+{
+    internal::device_settings<HistorySettings>().set_settings(id, settings);
+    if (!settings.enabled)
+        internal::history_manager().ring(id).clear();
+}
+
+auto extract_history(DeviceId const& id, std::chrono::milliseconds duration) -> std::vector<HistoryFrame>
+{
+    return internal::history_manager().ring(id).extract(duration);
+}
+
+auto decode_history(std::vector<HistoryFrame> const& frames) -> std::vector<MaybeImage>
+{
+    return internal::decode_history_frames(frames);
+}
+
+auto get_thread_settings(ThreadRole role) -> ThreadSettings
+{
+    return internal::thread_settings_manager().settings(role);
+}
+
+void set_thread_settings(ThreadRole role, ThreadSettings settings)
+{
+    internal::thread_settings_manager().set_settings(role, std::move(settings));
+}
+
 } // namespace wcam
\ No newline at end of file
@@ -157,6 +157,19 @@ public:
         if (!_webcam.has_value())
             return;
 
+        {
+            auto max_fps     = _webcam->max_fps();
+            bool has_max_fps = max_fps.has_value();
+            if (ImGui::Checkbox("Limit FPS", &has_max_fps))
+                _webcam->set_max_fps(has_max_fps ? std::make_optional(5.f) : std::nullopt);
+            if (max_fps.has_value())
+            {
+                ImGui::SameLine();
+                if (ImGui::SliderFloat("Max FPS", &*max_fps, 1.f, 60.f))
+                    _webcam->set_max_fps(max_fps);
+            }
+        }
+
         _maybe_image = _webcam->image(); // We need to keep the image alive till the end of the frame, so we take a copy of the shared_ptr. The image stored in the _webcam can be destroyed at any time if a new image is created by the background thread
         std::visit(
             wcam::overloaded{